@@ -0,0 +1,239 @@
+#ifndef BUCKET_QUEUE_H
+#define BUCKET_QUEUE_H
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <cstdint>
+#include <assert.h>
+
+#include "DaryHeap.h"
+
+// Priority queue for integer weights in [0, maxWeight]: one bucket per
+// weight and a cursor at the lowest bucket that may be non-empty. Push and
+// decrease are O(1); pop scans forward from the cursor, so a whole run of
+// pops costs O(maxWeight) plus the items. Keys do not need to be popped in
+// increasing order. Supports the same Index policies as DaryHeap.
+template <class T, class WeightOf, class Index = NoIndex>
+class BucketQueue
+{
+public:
+    explicit BucketQueue(unsigned maxWeight, size_t keyCount = 0, WeightOf weightOf = WeightOf())
+        : m_Buckets(maxWeight + 1)
+        , m_Bucket(keyCount, 0)
+        , m_Cursor(maxWeight + 1)
+        , m_Size(0)
+        , m_WeightOf(weightOf)
+        , m_Index(keyCount)
+    {}
+
+    bool empty() const
+    {
+        return m_Size == 0;
+    }
+
+    size_t size() const
+    {
+        return m_Size;
+    }
+
+    const T& top()
+    {
+        advance();
+        return m_Buckets[m_Cursor].back();
+    }
+
+    void push(const T& item)
+    {
+        size_t bucket = m_WeightOf(item);
+        assert(bucket < m_Buckets.size());
+
+        place(item, bucket);
+        m_Cursor = std::min(m_Cursor, bucket);
+        ++m_Size;
+    }
+
+    T pop()
+    {
+        advance();
+
+        std::vector<T>& bucket = m_Buckets[m_Cursor];
+        T result = std::move(bucket.back());
+        bucket.pop_back();
+        m_Index.remove(result);
+        --m_Size;
+
+        return result;
+    }
+
+    // --- KeyIndex only ---
+
+    bool contains(int key) const
+    {
+        return m_Index.position(key) != -1;
+    }
+
+    const T& get(int key) const
+    {
+        return m_Buckets[m_Bucket[key]][m_Index.position(key)];
+    }
+
+    void decrease(const T& item)
+    {
+        int key = m_Index.key(item);
+        assert(contains(key) && m_WeightOf(item) <= m_WeightOf(get(key)));
+
+        erase(key);
+        push(item);
+    }
+
+    bool pushOrDecrease(const T& item)
+    {
+        int key = m_Index.key(item);
+        if (!contains(key))
+        {
+            push(item);
+            return true;
+        }
+        if (m_WeightOf(item) < m_WeightOf(get(key)))
+        {
+            decrease(item);
+            return true;
+        }
+        return false;
+    }
+
+private:
+    void advance()
+    {
+        assert(m_Size != 0);
+        while (m_Buckets[m_Cursor].empty())
+        {
+            ++m_Cursor;
+        }
+    }
+
+    void place(const T& item, size_t bucket)
+    {
+        m_Buckets[bucket].push_back(item);
+        m_Index.place(item, m_Buckets[bucket].size() - 1);
+        remember(m_Index, item, bucket);
+    }
+
+    // removes the item with 'key' by moving the last item of its bucket into its slot
+    void erase(int key)
+    {
+        std::vector<T>& bucket = m_Buckets[m_Bucket[key]];
+        size_t slot = m_Index.position(key);
+
+        m_Index.remove(bucket[slot]);
+        if (slot + 1 != bucket.size())
+        {
+            bucket[slot] = std::move(bucket.back());
+            m_Index.place(bucket[slot], slot);
+        }
+        bucket.pop_back();
+        --m_Size;
+    }
+
+    template <class KeyOf>
+    void remember(KeyIndex<KeyOf>& index, const T& item, size_t bucket)
+    {
+        m_Bucket[index.key(item)] = bucket;
+    }
+
+    void remember(NoIndex&, const T&, size_t)
+    {}
+
+    std::vector<std::vector<T>> m_Buckets;
+    std::vector<size_t> m_Bucket;
+    size_t m_Cursor;
+    size_t m_Size;
+    WeightOf m_WeightOf;
+    Index m_Index;
+};
+
+// Monotone radix heap over 32-bit keys: pushed keys must not be smaller
+// than the last popped one, as in Dijkstra-style frontiers. Bucket i holds
+// the keys whose highest bit differing from the last popped key is i-1, so
+// an item moves to a lower bucket at most 32 times: pushes are O(1) and
+// pops amortized O(log C) without comparisons between items. There is no
+// decrease-key; push the cheaper entry again and skip stale pops.
+template <class T, class KeyOf>
+class RadixHeap
+{
+public:
+    explicit RadixHeap(KeyOf keyOf = KeyOf())
+        : m_Buckets(33)
+        , m_Last(0)
+        , m_Size(0)
+        , m_KeyOf(keyOf)
+    {}
+
+    bool empty() const
+    {
+        return m_Size == 0;
+    }
+
+    size_t size() const
+    {
+        return m_Size;
+    }
+
+    void push(const T& item)
+    {
+        uint32_t key = m_KeyOf(item);
+        assert(key >= m_Last);
+
+        m_Buckets[bucketOf(key)].push_back(item);
+        ++m_Size;
+    }
+
+    T pop()
+    {
+        assert(m_Size != 0);
+
+        if (m_Buckets[0].empty())
+        {
+            size_t i = 1;
+            while (m_Buckets[i].empty())
+            {
+                ++i;
+            }
+
+            std::vector<T> items;
+            items.swap(m_Buckets[i]);
+
+            m_Last = std::numeric_limits<uint32_t>::max();
+            for (const T& item: items)
+            {
+                m_Last = std::min<uint32_t>(m_Last, m_KeyOf(item));
+            }
+            for (T& item: items)
+            {
+                m_Buckets[bucketOf(m_KeyOf(item))].push_back(std::move(item));
+            }
+        }
+
+        T result = std::move(m_Buckets[0].back());
+        m_Buckets[0].pop_back();
+        --m_Size;
+
+        return result;
+    }
+
+private:
+    size_t bucketOf(uint32_t key) const
+    {
+        uint32_t diff = key ^ m_Last;
+        return diff == 0 ? 0 : 32 - __builtin_clz(diff);
+    }
+
+    std::vector<std::vector<T>> m_Buckets;
+    uint32_t m_Last;
+    size_t m_Size;
+    KeyOf m_KeyOf;
+};
+
+#endif
@@ -0,0 +1,258 @@
+#ifndef DARY_HEAP_H
+#define DARY_HEAP_H
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <assert.h>
+
+// Index policy of a heap that does not track positions.
+struct NoIndex
+{
+    explicit NoIndex(size_t)
+    {}
+
+    template <class T>
+    void place(const T&, size_t)
+    {}
+
+    template <class T>
+    void remove(const T&)
+    {}
+};
+
+// Index policy mapping an item's key (KeyOf(item), in [0, keyCount)) to
+// its position in the heap, which allows contains/get/decrease by key.
+template <class KeyOf>
+class KeyIndex
+{
+public:
+    explicit KeyIndex(size_t keyCount, KeyOf keyOf = KeyOf())
+        : m_Position(keyCount, -1)
+        , m_KeyOf(keyOf)
+    {}
+
+    template <class T>
+    void place(const T& item, size_t position)
+    {
+        m_Position[m_KeyOf(item)] = position;
+    }
+
+    template <class T>
+    void remove(const T& item)
+    {
+        m_Position[m_KeyOf(item)] = -1;
+    }
+
+    template <class T>
+    int key(const T& item) const
+    {
+        return m_KeyOf(item);
+    }
+
+    int position(int key) const
+    {
+        return m_Position[key];
+    }
+
+private:
+    std::vector<int> m_Position;
+    KeyOf m_KeyOf;
+};
+
+// Min-heap with Arity children per node. Arity 4 or 8 keeps the siblings
+// compared on a sink within one or two cache lines. Sifts move a hole
+// instead of swapping, so every level costs one move and one index update.
+// With a KeyIndex policy the heap also supports lookup and decrease-key.
+template <class T, unsigned Arity = 4, class Compare = std::less<T>, class Index = NoIndex>
+class DaryHeap
+{
+    static_assert(Arity >= 2, "a heap node needs at least two children");
+
+public:
+    explicit DaryHeap(size_t keyCount = 0, Compare comparator = Compare())
+        : m_Items()
+        , m_Comparator(comparator)
+        , m_Index(keyCount)
+    {}
+
+    bool empty() const
+    {
+        return m_Items.empty();
+    }
+
+    size_t size() const
+    {
+        return m_Items.size();
+    }
+
+    const T& top() const
+    {
+        return m_Items.front();
+    }
+
+    void push(const T& item)
+    {
+        m_Items.push_back(item);
+        siftUp(m_Items.size() - 1, item);
+    }
+
+    T pop()
+    {
+        T result = std::move(m_Items.front());
+        m_Index.remove(result);
+
+        T last = std::move(m_Items.back());
+        m_Items.pop_back();
+        if (!m_Items.empty())
+        {
+            siftDown(0, std::move(last));
+        }
+
+        return result;
+    }
+
+    const std::vector<T>& items() const
+    {
+        return m_Items;
+    }
+
+    // empties the heap, keeping its storage
+    void clear()
+    {
+        for (const T& item: m_Items)
+        {
+            m_Index.remove(item);
+        }
+        m_Items.clear();
+    }
+
+    // --- KeyIndex only ---
+
+    bool contains(int key) const
+    {
+        return m_Index.position(key) != -1;
+    }
+
+    const T& get(int key) const
+    {
+        return m_Items[m_Index.position(key)];
+    }
+
+    // replaces the item with the same key by 'item', which must not order after it
+    void decrease(const T& item)
+    {
+        int position = m_Index.position(m_Index.key(item));
+        assert(position != -1 && !m_Comparator(m_Items[position], item));
+        siftUp(position, item);
+    }
+
+    // inserts 'item', or decreases the item with its key when 'item' orders
+    // before it; returns whether the heap changed
+    bool pushOrDecrease(const T& item)
+    {
+        int position = m_Index.position(m_Index.key(item));
+        if (position == -1)
+        {
+            push(item);
+            return true;
+        }
+        if (m_Comparator(item, m_Items[position]))
+        {
+            siftUp(position, item);
+            return true;
+        }
+        return false;
+    }
+
+    // drops every item matching 'predicate' and rebuilds the heap bottom-up, O(n)
+    template <class Predicate>
+    void removeIf(Predicate predicate)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < m_Items.size(); ++i)
+        {
+            if (predicate(m_Items[i]))
+            {
+                m_Index.remove(m_Items[i]);
+            }
+            else
+            {
+                if (kept != i)
+                {
+                    m_Items[kept] = std::move(m_Items[i]);
+                }
+                m_Index.place(m_Items[kept], kept);
+                ++kept;
+            }
+        }
+        m_Items.erase(m_Items.begin() + kept, m_Items.end());
+
+        for (size_t i = kept / Arity + 1; i-- > 0; )
+        {
+            if (i < kept)
+            {
+                T item = std::move(m_Items[i]);
+                siftDown(i, std::move(item));
+            }
+        }
+    }
+
+private:
+    void siftUp(size_t hole, T item)
+    {
+        while (hole > 0)
+        {
+            size_t parent = (hole - 1) / Arity;
+            if (!m_Comparator(item, m_Items[parent]))
+            {
+                break;
+            }
+            m_Items[hole] = std::move(m_Items[parent]);
+            m_Index.place(m_Items[hole], hole);
+            hole = parent;
+        }
+        m_Items[hole] = std::move(item);
+        m_Index.place(m_Items[hole], hole);
+    }
+
+    void siftDown(size_t hole, T item)
+    {
+        const size_t count = m_Items.size();
+        while (true)
+        {
+            size_t first = hole * Arity + 1;
+            if (first >= count)
+            {
+                break;
+            }
+
+            size_t best = first;
+            size_t last = std::min(first + Arity, count);
+            for (size_t child = first + 1; child < last; ++child)
+            {
+                if (m_Comparator(m_Items[child], m_Items[best]))
+                {
+                    best = child;
+                }
+            }
+
+            if (!m_Comparator(m_Items[best], item))
+            {
+                break;
+            }
+            m_Items[hole] = std::move(m_Items[best]);
+            m_Index.place(m_Items[hole], hole);
+            hole = best;
+        }
+        m_Items[hole] = std::move(item);
+        m_Index.place(m_Items[hole], hole);
+    }
+
+    std::vector<T> m_Items;
+    Compare m_Comparator;
+    Index m_Index;
+};
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef DIJKSTRA_CONTEXT_H
+#define DIJKSTRA_CONTEXT_H
+
+#include <vector>
+#include <functional>
+#include <assert.h>
+
+#include "DaryHeap.h"
+
+// Heap entry: a vertex with its tentative path. Ties go to the lower
+// vertex, so the search order does not depend on the heap layout.
+struct QueuedVertex
+{
+    int vertex;
+    int path;
+};
+
+inline bool operator<(const QueuedVertex& left, const QueuedVertex& right)
+{
+    return left.path < right.path || (left.path == right.path && left.vertex < right.vertex);
+}
+
+struct QueuedVertexKey
+{
+    int operator()(const QueuedVertex& queued) const
+    {
+        return queued.vertex;
+    }
+};
+
+typedef DaryHeap<QueuedVertex, 4, std::less<QueuedVertex>, KeyIndex<QueuedVertexKey>> VertexHeap;
+
+template <class Result>
+class DijkstraContext;
+
+template <class Graph, class Result>
+const std::vector<Result>& Dijkstra(const Graph& graph, int source, DijkstraContext<Result>& context, int target = -1);
+
+// Per-thread state of Dijkstra queries on graphs of one size. The result
+// vector and the heap are allocated once; a query only resets the entries
+// the previous query touched. 'Result' is the module's {from, path} pair.
+template <class Result>
+class DijkstraContext
+{
+public:
+    explicit DijkstraContext(size_t size)
+        : m_Result(size, {-1, 999999})
+        , m_Done(size, false)
+        , m_Touched()
+        , m_Heap(size)
+    {}
+
+    const std::vector<Result>& results() const
+    {
+        return m_Result;
+    }
+
+private:
+    template <class Graph, class R>
+    friend const std::vector<R>& Dijkstra(const Graph&, int, DijkstraContext<R>&, int);
+
+    void reset()
+    {
+        for (int vertex: m_Touched)
+        {
+            m_Result[vertex] = {-1, 999999};
+            m_Done[vertex] = false;
+        }
+        m_Touched.clear();
+        m_Heap.clear();
+    }
+
+    std::vector<Result> m_Result;
+    std::vector<bool> m_Done;
+    std::vector<int> m_Touched;
+    VertexHeap m_Heap;
+};
+
+// Dijkstra with decrease-key for non-negative weights. With a 'target' the
+// search stops once the target is settled: its entry and those of the
+// vertices settled before it are final, the others are upper bounds or
+// unset. The returned reference stays valid until the next query on the
+// same context.
+template <class Graph, class Result>
+const std::vector<Result>& Dijkstra(const Graph& graph, int source, DijkstraContext<Result>& context, int target)
+{
+    assert(context.m_Result.size() == graph.size());
+    context.reset();
+
+    std::vector<Result>& result = context.m_Result;
+    VertexHeap& heap = context.m_Heap;
+
+    result[source] = {source, 0};
+    context.m_Touched.push_back(source);
+    heap.push({source, 0});
+
+    while (!heap.empty())
+    {
+        int vertex = heap.pop().vertex;
+        context.m_Done[vertex] = true;
+
+        if (vertex == target)
+        {
+            break;
+        }
+
+        for (const auto& edge: graph.connected(vertex))
+        {
+            assert(edge.weight() >= 0);
+
+            int next = edge.to();
+            if (!context.m_Done[next] && result[vertex].path + edge.weight() < result[next].path)
+            {
+                if (result[next].from == -1)
+                {
+                    context.m_Touched.push_back(next);
+                }
+                result[next].path = result[vertex].path + edge.weight();
+                result[next].from = vertex;
+                heap.pushOrDecrease({next, result[next].path});
+            }
+        }
+    }
+
+    return result;
+}
+
+#endif
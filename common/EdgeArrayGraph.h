@@ -0,0 +1,123 @@
+#ifndef EDGE_ARRAY_GRAPH_H
+#define EDGE_ARRAY_GRAPH_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <assert.h>
+
+// Undirected weighted graph storing every edge once: from/to/weight live in
+// three parallel arrays indexed by the edge id returned from add(), and the
+// per-vertex adjacency lists hold 32-bit edge ids only. Ids stay valid after
+// deleteEdge, which only unlinks the edge from both adjacency lists.
+class EdgeArrayGraph
+{
+public:
+    explicit EdgeArrayGraph(size_t size)
+        : m_From()
+        , m_To()
+        , m_Weight()
+        , m_Deleted()
+        , m_Adjacents(size)
+    {}
+
+    uint32_t add(int from, int to, int weight)
+    {
+        uint32_t id = m_From.size();
+
+        m_From.push_back(from);
+        m_To.push_back(to);
+        m_Weight.push_back(weight);
+        m_Deleted.push_back(false);
+
+        m_Adjacents[from].push_back(id);
+        if (to != from)
+        {
+            m_Adjacents[to].push_back(id);
+        }
+
+        return id;
+    }
+
+    // anything with from()/to()/weight(), e.g. Edge
+    template <class EdgeT>
+    uint32_t add(const EdgeT& edge)
+    {
+        return add(edge.from(), edge.to(), edge.weight());
+    }
+
+    void deleteEdge(uint32_t id)
+    {
+        assert(!m_Deleted[id]);
+        m_Deleted[id] = true;
+        unlink(m_From[id], id);
+        unlink(m_To[id], id);
+    }
+
+    // number of vertices
+    size_t size() const
+    {
+        return m_Adjacents.size();
+    }
+
+    // number of edge ids handed out, deleted ones included
+    size_t edgeCount() const
+    {
+        return m_From.size();
+    }
+
+    const std::vector<uint32_t>& adjacents(int vertex) const
+    {
+        return m_Adjacents[vertex];
+    }
+
+    int from(uint32_t id) const
+    {
+        return m_From[id];
+    }
+
+    int to(uint32_t id) const
+    {
+        return m_To[id];
+    }
+
+    int weight(uint32_t id) const
+    {
+        return m_Weight[id];
+    }
+
+    int other(uint32_t id, int vertex) const
+    {
+        assert(vertex == m_From[id] || vertex == m_To[id]);
+        return vertex == m_To[id] ? m_From[id] : m_To[id];
+    }
+
+    bool isDeleted(uint32_t id) const
+    {
+        return m_Deleted[id];
+    }
+
+    const std::vector<int>& weights() const
+    {
+        return m_Weight;
+    }
+
+private:
+    void unlink(int vertex, uint32_t id)
+    {
+        std::vector<uint32_t>& ids = m_Adjacents[vertex];
+        std::vector<uint32_t>::iterator it = std::find(ids.begin(), ids.end(), id);
+        if (it != ids.end())
+        {
+            ids.erase(it);
+        }
+    }
+
+    std::vector<int> m_From;
+    std::vector<int> m_To;
+    std::vector<int> m_Weight;
+    std::vector<bool> m_Deleted;
+    std::vector<std::vector<uint32_t>> m_Adjacents;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include <vector>
 #include <list>
+#include <deque>
 #include <string>
 #include <algorithm>
 #include <limits>
@@ -102,12 +103,7 @@ class Graph
             return m_Edges.size();
         }
 
-        std::vector<Edge*> adjacents(int vertex)
-        {
-            return m_Edges[vertex];
-        }
-
-        const std::vector<Edge*> adjacents(int vertex) const
+        const std::vector<Edge*>& adjacents(int vertex) const
         {
             return m_Edges[vertex];
         }
@@ -226,9 +222,445 @@ std::vector<int> FordFulkerson(Graph& graph, int source, int target)
 
 
 
-#include <cppunit/extensions/TestFactoryRegistry.h>
-#include <cppunit/ui/text/TestRunner.h>
-#include <cppunit/extensions/HelperMacros.h>
+// Dinic: BFS levels over the residual graph, then a blocking flow along
+// arcs that go exactly one level up, repeated until the target drops out
+// of the level graph. 'level' is -1 for vertices the BFS did not reach.
+bool dinicLevels(const Graph& graph, int source, int target, std::vector<int>& level)
+{
+    level.assign(graph.size(), -1);
+    level[source] = 0;
+
+    std::vector<int> queue(1, source);
+    for (size_t head = 0; head < queue.size(); ++head)
+    {
+        int vertex = queue[head];
+        for (const Edge* edge: graph.adjacents(vertex))
+        {
+            int next = edge->other(vertex);
+            if (level[next] == -1 && edge->remainingFlow(vertex))
+            {
+                level[next] = level[vertex] + 1;
+                queue.push_back(next);
+            }
+        }
+    }
+
+    return level[target] != -1;
+}
+
+// Iterative DFS over the level graph. 'current' is the next arc to try at
+// each vertex: an arc is skipped for good once it is saturated or leads to
+// a dead end, so every arc is passed over at most once per phase. After an
+// augmentation the search resumes from the tail of the first saturated arc.
+int dinicBlockingFlow(Graph& graph, int source, int target, const std::vector<int>& level, std::vector<size_t>& current)
+{
+    std::vector<Edge*> path;
+    std::vector<int> vertice(1, source);
+    int total = 0;
+
+    while (true)
+    {
+        int vertex = vertice.back();
+
+        if (vertex == target)
+        {
+            int flow = std::numeric_limits<int>::max();
+            for (size_t i = 0; i < path.size(); ++i)
+            {
+                flow = std::min(flow, path[i]->remainingFlow(vertice[i]));
+            }
+
+            size_t saturated = path.size();
+            for (size_t i = 0; i < path.size(); ++i)
+            {
+                path[i]->pushFlow(flow, vertice[i]);
+                if (saturated == path.size() && path[i]->remainingFlow(vertice[i]) == 0)
+                {
+                    saturated = i;
+                }
+            }
+            total += flow;
+
+            path.resize(saturated);
+            vertice.resize(saturated + 1);
+            continue;
+        }
+
+        const std::vector<Edge*>& edges = graph.adjacents(vertex);
+        size_t& arc = current[vertex];
+        while (arc < edges.size() &&
+               !(edges[arc]->remainingFlow(vertex) && level[edges[arc]->other(vertex)] == level[vertex] + 1))
+        {
+            ++arc;
+        }
+
+        if (arc < edges.size())
+        {
+            path.push_back(edges[arc]);
+            vertice.push_back(edges[arc]->other(vertex));
+        }
+        else if (vertex == source)
+        {
+            return total;
+        }
+        else
+        {
+            path.pop_back();
+            vertice.pop_back();
+            ++current[vertice.back()];
+        }
+    }
+}
+
+// Source side of a minimum cut. With source == target there is nothing to
+// push: the flow stays zero and the side is what the source reaches.
+std::vector<int> Dinic(Graph& graph, int source, int target)
+{
+    if (source == target)
+    {
+        return dfs_SourceGroup(graph, source);
+    }
+
+    std::vector<int> level;
+    std::vector<size_t> current;
+
+    while (dinicLevels(graph, source, target, level))
+    {
+        current.assign(graph.size(), 0);
+        dinicBlockingFlow(graph, source, target, level, current);
+    }
+
+    return dfs_SourceGroup(graph, source);
+}
+
+
+
+// Push-relabel max-flow. Phase one moves a maximum preflow into the
+// target; the minimum cut is known at its end. Phase two returns the
+// excess left inside the network to the source, which leaves a valid
+// flow. Active vertices are taken first in first out, or highest label
+// first. Labels are recomputed exactly by a reverse BFS from the sink
+// after every V relabels, and in phase one a label left empty by a
+// relabel (a gap) lifts every vertex above it out of the target's reach.
+class PushRelabel
+{
+public:
+    enum Selection
+    {
+        FIFO,
+        HIGHEST_LABEL
+    };
+
+    struct MinCut
+    {
+        int value;
+        std::vector<int> sourceSide;
+    };
+
+    PushRelabel(Graph& graph, int source, int target, Selection selection = HIGHEST_LABEL)
+        : m_Graph(graph)
+        , m_Source(source)
+        , m_Target(target)
+        , m_Selection(selection)
+        , m_Size(graph.size())
+        , m_Label(m_Size, 0)
+        , m_Excess(m_Size, 0)
+        , m_Current(m_Size, 0)
+        , m_Count(m_Size + 1, 0)
+        , m_Buckets(2 * m_Size + 1)
+        , m_Highest(-1)
+        , m_Relabels(0)
+        , m_Phase(0)
+    {}
+
+    // runs phase one if it has not run yet; the source side holds the
+    // vertices that cannot reach the target in the residual graph, the
+    // largest source side of any minimum cut
+    MinCut minCut()
+    {
+        if (m_Phase < 1)
+        {
+            preflow();
+        }
+
+        return {m_Excess[m_Target], m_SourceSide};
+    }
+
+    // runs both phases; afterwards the graph holds a maximum flow
+    int maxFlow()
+    {
+        if (m_Phase < 1)
+        {
+            preflow();
+        }
+        if (m_Phase < 2)
+        {
+            returnExcess();
+        }
+        return m_Excess[m_Target];
+    }
+
+private:
+    void preflow()
+    {
+        // as in Dinic: with source == target nothing is pushed, the flow
+        // is zero and the source side is what the source reaches
+        if (m_Source == m_Target)
+        {
+            m_SourceSide = dfs_SourceGroup(m_Graph, m_Source);
+            m_Phase = 2;
+            return;
+        }
+
+        for (Edge* edge: m_Graph.adjacents(m_Source))
+        {
+            int residual = edge->remainingFlow(m_Source);
+            int next = edge->other(m_Source);
+            if (residual && next != m_Source)
+            {
+                edge->pushFlow(residual, m_Source);
+                m_Excess[m_Source] -= residual;
+                m_Excess[next] += residual;
+            }
+        }
+
+        run(m_Target, m_Size, true);
+
+        globalRelabel(m_Target, m_Size);
+        for (int vertex = 0; vertex < m_Size; ++vertex)
+        {
+            if (m_Label[vertex] >= m_Size)
+            {
+                m_SourceSide.push_back(vertex);
+            }
+        }
+        m_Phase = 1;
+    }
+
+    void returnExcess()
+    {
+        run(m_Source, 2 * m_Size, false);
+        m_Phase = 2;
+    }
+
+    // discharges active vertices toward 'sink' until none is left below
+    // 'limit'
+    void run(int sink, int limit, bool gaps)
+    {
+        globalRelabel(sink, limit);
+
+        for (int vertex; (vertex = nextActive(limit)) != -1; )
+        {
+            discharge(vertex, sink, limit, gaps);
+
+            if (m_Relabels >= static_cast<size_t>(m_Size))
+            {
+                globalRelabel(sink, limit);
+            }
+        }
+    }
+
+    bool isActive(int vertex, int limit) const
+    {
+        return vertex != m_Source && vertex != m_Target && m_Excess[vertex] > 0 && m_Label[vertex] < limit;
+    }
+
+    void activate(int vertex)
+    {
+        if (m_Selection == FIFO)
+        {
+            m_Queue.push_back(vertex);
+        }
+        else
+        {
+            m_Buckets[m_Label[vertex]].push_back(vertex);
+            m_Highest = std::max(m_Highest, m_Label[vertex]);
+        }
+    }
+
+    // the next active vertex, skipping entries a gap or a global relabel
+    // made stale; -1 when there is none
+    int nextActive(int limit)
+    {
+        if (m_Selection == FIFO)
+        {
+            while (!m_Queue.empty())
+            {
+                int vertex = m_Queue.front();
+                m_Queue.pop_front();
+                if (isActive(vertex, limit))
+                {
+                    return vertex;
+                }
+            }
+            return -1;
+        }
+
+        for (; m_Highest >= 0; --m_Highest)
+        {
+            std::vector<int>& bucket = m_Buckets[m_Highest];
+            while (!bucket.empty())
+            {
+                int vertex = bucket.back();
+                bucket.pop_back();
+                if (isActive(vertex, limit) && m_Label[vertex] == m_Highest)
+                {
+                    return vertex;
+                }
+            }
+        }
+        return -1;
+    }
+
+    // exact labels: BFS distance to 'sink' over residual arcs, 'limit' for
+    // vertices that cannot reach it; rebuilds the active set
+    void globalRelabel(int sink, int limit)
+    {
+        std::fill(m_Label.begin(), m_Label.end(), limit);
+        std::fill(m_Count.begin(), m_Count.end(), 0);
+        m_Label[sink] = 0;
+
+        std::vector<int> queue(1, sink);
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            int vertex = queue[head];
+            if (m_Label[vertex] < m_Size)
+            {
+                ++m_Count[m_Label[vertex]];
+            }
+            for (const Edge* edge: m_Graph.adjacents(vertex))
+            {
+                int previous = edge->other(vertex);
+                if (m_Label[previous] == limit && previous != m_Source && previous != m_Target &&
+                    edge->remainingFlow(previous))
+                {
+                    m_Label[previous] = m_Label[vertex] + 1;
+                    queue.push_back(previous);
+                }
+            }
+        }
+        if (sink == m_Target)
+        {
+            m_Label[m_Source] = std::max(m_Label[m_Source], m_Size);
+        }
+
+        m_Queue.clear();
+        for (std::vector<int>& bucket: m_Buckets)
+        {
+            bucket.clear();
+        }
+        m_Highest = -1;
+        for (int vertex = 0; vertex < m_Size; ++vertex)
+        {
+            m_Current[vertex] = 0;
+            if (isActive(vertex, limit))
+            {
+                activate(vertex);
+            }
+        }
+        m_Relabels = 0;
+    }
+
+    void discharge(int vertex, int sink, int limit, bool gaps)
+    {
+        const std::vector<Edge*>& edges = m_Graph.adjacents(vertex);
+
+        while (m_Excess[vertex] > 0)
+        {
+            size_t& arc = m_Current[vertex];
+            if (arc == edges.size())
+            {
+                relabel(vertex, sink, limit, gaps);
+                if (m_Label[vertex] >= limit)
+                {
+                    return;
+                }
+                continue;
+            }
+
+            Edge* edge = edges[arc];
+            int next = edge->other(vertex);
+            int residual = edge->remainingFlow(vertex);
+            bool blocked = next == (sink == m_Target ? m_Source : m_Target);
+
+            if (residual && !blocked && m_Label[vertex] == m_Label[next] + 1)
+            {
+                int flow = std::min(m_Excess[vertex], residual);
+                edge->pushFlow(flow, vertex);
+                m_Excess[vertex] -= flow;
+                m_Excess[next] += flow;
+                if (m_Excess[next] == flow && isActive(next, limit))
+                {
+                    activate(next);
+                }
+            }
+            else
+            {
+                ++arc;
+            }
+        }
+    }
+
+    void relabel(int vertex, int sink, int limit, bool gaps)
+    {
+        const int old = m_Label[vertex];
+        int label = limit;
+        for (const Edge* edge: m_Graph.adjacents(vertex))
+        {
+            int next = edge->other(vertex);
+            bool blocked = next == (sink == m_Target ? m_Source : m_Target);
+            if (edge->remainingFlow(vertex) && !blocked)
+            {
+                label = std::min(label, m_Label[next] + 1);
+            }
+        }
+        label = std::min(label, limit);
+
+        m_Label[vertex] = label;
+        m_Current[vertex] = 0;
+        ++m_Relabels;
+
+        if (!gaps)
+        {
+            return;
+        }
+
+        --m_Count[old];
+        if (label < m_Size)
+        {
+            ++m_Count[label];
+        }
+        if (m_Count[old] == 0)
+        {
+            for (int other = 0; other < m_Size; ++other)
+            {
+                if (m_Label[other] > old && m_Label[other] < m_Size)
+                {
+                    --m_Count[m_Label[other]];
+                    m_Label[other] = m_Size;
+                }
+            }
+        }
+    }
+
+    Graph& m_Graph;
+    const int m_Source;
+    const int m_Target;
+    const Selection m_Selection;
+    const int m_Size;
+
+    std::vector<int> m_Label;
+    std::vector<int> m_Excess;
+    std::vector<size_t> m_Current;
+    std::vector<int> m_Count;
+    std::deque<int> m_Queue;
+    std::vector<std::vector<int>> m_Buckets;
+    int m_Highest;
+    size_t m_Relabels;
+    int m_Phase;
+    std::vector<int> m_SourceSide;
+};
+
 
 std::ostream& operator<<(std::ostream& os, const Edge& v)
 {
@@ -255,6 +687,10 @@ std::ostream& operator<<(std::ostream& os, const std::vector<T>& v)
     return os;
 }
 
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+
 // std::ostream& operator<<(std::ostream& os, const std::vector<Edge>& v)
 // {
 //     os << '[';
@@ -281,6 +717,7 @@ class Test: public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST( test2 );
     CPPUNIT_TEST( test3 );
     CPPUNIT_TEST( test4 );
+    CPPUNIT_TEST( test5 );
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -289,10 +726,83 @@ public:
     void test2();
     void test3();
     void test4();
+    void test5();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( Test );
 
+Graph testGraph()
+{
+    Graph graph(8);
+
+    graph.add(Edge(0, 1, 10));
+    graph.add(Edge(0, 2, 5));
+    graph.add(Edge(0, 3, 15));
+
+    graph.add(Edge(1, 4, 9));
+    graph.add(Edge(1, 5, 15));
+
+    graph.add(Edge(2, 5, 8));
+    graph.add(Edge(2, 3, 4));
+
+    graph.add(Edge(3, 6, 16));
+
+    graph.add(Edge(4, 5, 15));
+    graph.add(Edge(4, 7, 10));
+
+    graph.add(Edge(5, 6, 15));
+    graph.add(Edge(5, 7, 10));
+
+    graph.add(Edge(6, 2, 6));
+    graph.add(Edge(6, 7, 10));
+
+    return graph;
+}
+
+// net flow out of 'vertex'
+int outFlow(const Graph& graph, int vertex)
+{
+    int flow = 0;
+    for (const Edge* edge: graph.adjacents(vertex))
+    {
+        flow += edge->from() == vertex ? edge->flow() : -edge->flow();
+    }
+    return flow;
+}
+
+// flows within capacities and conserved everywhere but at the ends
+void checkFlow(const Graph& graph, int source, int target)
+{
+    for (size_t vertex = 0; vertex < graph.size(); ++vertex)
+    {
+        for (const Edge* edge: graph.adjacents(vertex))
+        {
+            CPPUNIT_ASSERT(edge->flow() >= 0 && edge->flow() <= edge->capacity());
+        }
+        if (int(vertex) != source && int(vertex) != target)
+        {
+            CPPUNIT_ASSERT_EQUAL(0, outFlow(graph, vertex));
+        }
+    }
+}
+
+// pseudo-random network with a few high-capacity hubs
+Graph randomGraph(int size, int edges, uint seed)
+{
+    Graph graph(size);
+    for (int i = 0; i < edges; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        int from = (seed >> 8) % size;
+        int to = (seed >> 16) % size;
+        if (from != to)
+        {
+            graph.add(Edge(from, to, from % 5 == 0 ? 1000 : (seed >> 4) % 20 + 1));
+        }
+    }
+    return graph;
+}
+
 void Test::test1()
 {
     Graph graph(8);
@@ -330,17 +840,117 @@ void Test::test1()
 
 void Test::test2()
 {
+    Graph graph = testGraph();
 
+    std::vector<int> expect = {0, 2, 3, 6};
+    CPPUNIT_ASSERT_EQUAL(expect, Dinic(graph, 0, 7));
+    CPPUNIT_ASSERT_EQUAL(28, outFlow(graph, 0));
+    checkFlow(graph, 0, 7);
 }
 
 void Test::test3()
 {
+    for (uint seed = 1; seed <= 20; ++seed)
+    {
+        Graph byPaths = randomGraph(60, 300, seed);
+        Graph byLevels = randomGraph(60, 300, seed);
 
+        std::vector<int> expect = FordFulkerson(byPaths, 0, 59);
+        CPPUNIT_ASSERT_EQUAL(expect, Dinic(byLevels, 0, 59));
+        CPPUNIT_ASSERT_EQUAL(outFlow(byPaths, 0), outFlow(byLevels, 0));
+        checkFlow(byLevels, 0, 59);
+    }
+}
+
+// total capacity of the edges leaving 'side'
+int cutCapacity(const Graph& graph, const std::vector<int>& side)
+{
+    std::vector<bool> inside(graph.size(), false);
+    for (int vertex: side)
+    {
+        inside[vertex] = true;
+    }
+
+    int capacity = 0;
+    for (int vertex: side)
+    {
+        for (const Edge* edge: graph.adjacents(vertex))
+        {
+            if (edge->from() == vertex && !inside[edge->to()])
+            {
+                capacity += edge->capacity();
+            }
+        }
+    }
+    return capacity;
 }
 
 void Test::test4()
 {
+    for (PushRelabel::Selection selection: {PushRelabel::FIFO, PushRelabel::HIGHEST_LABEL})
+    {
+        Graph graph = testGraph();
+        PushRelabel solver(graph, 0, 7, selection);
+
+        PushRelabel::MinCut cut = solver.minCut();
+        CPPUNIT_ASSERT_EQUAL(28, cut.value);
+        CPPUNIT_ASSERT_EQUAL(28, cutCapacity(graph, cut.sourceSide));
+
+        CPPUNIT_ASSERT_EQUAL(28, solver.maxFlow());
+        checkFlow(graph, 0, 7);
+        std::vector<int> expect = {0, 2, 3, 6};
+        CPPUNIT_ASSERT_EQUAL(expect, dfs_SourceGroup(graph, 0));
 
+        for (uint seed = 1; seed <= 20; ++seed)
+        {
+            Graph byLevels = randomGraph(60, 300, seed);
+            Graph byLabels = randomGraph(60, 300, seed);
+
+            std::vector<int> expect = Dinic(byLevels, 0, 59);
+            int value = outFlow(byLevels, 0);
+
+            PushRelabel solver(byLabels, 0, 59, selection);
+            PushRelabel::MinCut cut = solver.minCut();
+            CPPUNIT_ASSERT_EQUAL(value, cut.value);
+            CPPUNIT_ASSERT_EQUAL(value, cutCapacity(byLabels, cut.sourceSide));
+            CPPUNIT_ASSERT(std::includes(cut.sourceSide.begin(), cut.sourceSide.end(), expect.begin(), expect.end()));
+
+            CPPUNIT_ASSERT_EQUAL(value, solver.maxFlow());
+            checkFlow(byLabels, 0, 59);
+            CPPUNIT_ASSERT_EQUAL(expect, dfs_SourceGroup(byLabels, 0));
+            CPPUNIT_ASSERT(cut.sourceSide == solver.minCut().sourceSide);
+        }
+    }
+}
+
+void Test::test5()
+{
+    // source == target: nothing is pushed and the source side is what
+    // the source reaches in the untouched graph
+    Graph graph = testGraph();
+
+    CPPUNIT_ASSERT_EQUAL(dfs_SourceGroup(testGraph(), 3), Dinic(graph, 3, 3));
+
+    Graph pushed = testGraph();
+    PushRelabel cut(pushed, 3, 3);
+    PushRelabel::MinCut minCut = cut.minCut();
+    CPPUNIT_ASSERT_EQUAL(0, minCut.value);
+    CPPUNIT_ASSERT_EQUAL(dfs_SourceGroup(testGraph(), 3), minCut.sourceSide);
+    CPPUNIT_ASSERT_EQUAL(0, cut.maxFlow());
+
+    Graph fifo = testGraph();
+    CPPUNIT_ASSERT_EQUAL(0, PushRelabel(fifo, 3, 3, PushRelabel::FIFO).maxFlow());
+
+    for (const Graph* flowed: {&graph, &pushed, &fifo})
+    {
+        for (size_t vertex = 0; vertex < flowed->size(); ++vertex)
+        {
+            for (const Edge* edge: flowed->adjacents(vertex))
+            {
+                CPPUNIT_ASSERT_EQUAL(0, edge->flow());
+            }
+        }
+    }
 }
 
 int main()
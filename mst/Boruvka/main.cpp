@@ -0,0 +1,525 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <cstdint>
+
+using namespace std;
+
+typedef unsigned int uint;
+
+class Edge
+{
+    public:
+    Edge(int from, int to, int weight)
+        : m_from(from)
+        , m_to(to)
+        , m_weight(weight)
+    {
+    }
+
+    int from() const
+    {
+        return m_from; 
+    }
+
+    int to() const
+    {
+        return m_to; 
+    }
+
+    int other(int vertex) const
+    {
+        return vertex == m_to ? m_from : m_to;
+    }
+
+    int weight() const
+    {
+        return m_weight; 
+    }
+
+private:
+    int m_from, m_to, m_weight;
+
+};
+
+class Graph
+{
+    public:
+        Graph(size_t size)
+            : m_Edges(size)
+        {}
+
+        void add(const Edge& edge)
+        {
+            m_Edges[edge.from()].push_back(edge);
+            m_Edges[edge.to()].push_back(edge);
+        }
+
+        size_t size() const
+        {
+            return m_Edges.size();
+        }
+
+        const std::vector<Edge>& adjacents(int vertex) const
+        {
+            return m_Edges[vertex];
+        }
+
+        void deleteEdge(const Edge& e)
+        {
+            std::vector<Edge>& v = m_Edges[e.from()];
+            for (std::vector<Edge>::iterator it = v.begin(); it != v.end(); ++it)
+            {
+               if (it->to() == e.to())
+               {
+                   v.erase(it);
+                   break;
+               } 
+            }
+
+
+            std::vector<Edge>& v1 = m_Edges[e.to()];
+            for (std::vector<Edge>::iterator it = v1.begin(); it != v1.end(); ++it)
+            {
+               if (it->from() == e.from())
+               {
+                   v1.erase(it);
+                   break;
+               } 
+            }
+        }
+
+    private:
+        std::vector<std::vector<Edge>> m_Edges;
+};
+
+
+
+bool operator==(const Edge& left, const Edge& right)
+{
+    return left.weight() == right.weight();
+}
+
+bool operator<(const Edge& left, const Edge& right)
+{
+    return left.weight() < right.weight();
+}
+
+
+class UnionFind
+{
+public:
+    UnionFind(uint size)
+        : m_Connect(size)
+        , m_Depth(size, 1)
+    {
+        for (uint i = 0; i < size; ++i)
+        {
+            m_Connect[i] = i;
+        }
+    }
+
+    void connect(int v1, int v2)
+    {
+        int root1 = root(v1);
+        int root2 = root(v2);
+
+        if (m_Depth[root1] > m_Depth[root2])
+        {
+            m_Connect[root2] = root1;
+        }
+        else if (m_Depth[root1] > m_Depth[root2])
+        {
+            m_Connect[root1] = root2;
+        }
+        else
+        {
+            m_Connect[root1] = root2;
+            ++m_Depth[root2];
+        }
+    }
+
+    bool isConnected(int v1, int v2)
+    {
+        return root(v1) == root(v2);
+    }
+
+    int root(int v)
+    {
+
+        int nextv;
+        while (v != (nextv = m_Connect[v]))
+        {
+            m_Connect[v] = m_Connect[nextv];
+            v = nextv;
+        }
+
+        return nextv;
+    }
+
+private:
+    std::vector<int> m_Connect;
+    std::vector<int> m_Depth;
+
+};
+
+
+// Maps a signed weight onto an unsigned key with the same ordering.
+inline uint32_t weightKey(int weight)
+{
+    return static_cast<uint32_t>(weight) ^ 0x80000000u;
+}
+
+// (weight, edge index) packed so that a plain integer minimum orders edges
+// by weight and breaks ties by index, the same order a stable Kruskal uses.
+inline uint64_t packEdge(int weight, uint32_t index)
+{
+    return (static_cast<uint64_t>(weightKey(weight)) << 32) | index;
+}
+
+const uint64_t NO_EDGE = std::numeric_limits<uint64_t>::max();
+
+void atomicMin(std::atomic<uint64_t>& target, uint64_t value)
+{
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+// Runs body(thread, begin, end) over [0, size) split into threadCount contiguous chunks.
+void parallelChunks(size_t size, uint threadCount, const std::function<void(uint, size_t, size_t)>& body)
+{
+    const size_t chunk = (size + threadCount - 1) / threadCount;
+
+    std::vector<std::thread> workers;
+    for (uint t = 1; t < threadCount; ++t)
+    {
+        workers.emplace_back(body, t, std::min(size, t * chunk), std::min(size, (t + 1) * chunk));
+    }
+    body(0, 0, std::min(size, chunk));
+    for (std::thread& worker: workers)
+    {
+        worker.join();
+    }
+}
+
+// Boruvka MST. Every round finds the cheapest edge leaving each component
+// in parallel (atomic compare-min on the packed edge key), contracts the
+// components through UnionFind and drops the edges that became internal.
+// The result is ordered as Kruskal with a stable sort would return it.
+std::vector<Edge> Boruvka(const std::vector<Edge>& graphEdges, uint graphSize, uint threadCount = 0)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    UnionFind uf(graphSize);
+    std::vector<int> component(graphSize);
+    std::vector<std::atomic<uint64_t>> cheapest(graphSize);
+
+    std::vector<uint32_t> live;
+    for (uint32_t i = 0; i < graphEdges.size(); ++i)
+    {
+        if (graphEdges[i].from() != graphEdges[i].to())
+        {
+            live.push_back(i);
+        }
+    }
+
+    std::vector<uint64_t> accepted;
+
+    while (!live.empty() && accepted.size() + 1 < graphSize)
+    {
+        for (uint v = 0; v < graphSize; ++v)
+        {
+            component[v] = uf.root(v);
+            cheapest[v].store(NO_EDGE, std::memory_order_relaxed);
+        }
+
+        uint threads = std::max<size_t>(1, std::min<size_t>(threadCount, live.size() / 4096));
+
+        parallelChunks(live.size(), threads, [&](uint, size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const Edge& edge = graphEdges[live[i]];
+                int from = component[edge.from()];
+                int to = component[edge.to()];
+                if (from != to)
+                {
+                    uint64_t key = packEdge(edge.weight(), live[i]);
+                    atomicMin(cheapest[from], key);
+                    atomicMin(cheapest[to], key);
+                }
+            }
+        });
+
+        for (uint v = 0; v < graphSize; ++v)
+        {
+            uint64_t key = cheapest[v].load(std::memory_order_relaxed);
+            if (component[v] != static_cast<int>(v) || key == NO_EDGE)
+            {
+                continue;
+            }
+
+            const Edge& edge = graphEdges[static_cast<uint32_t>(key)];
+            if (!uf.isConnected(edge.from(), edge.to()))
+            {
+                uf.connect(edge.from(), edge.to());
+                accepted.push_back(key);
+            }
+        }
+
+        for (uint v = 0; v < graphSize; ++v)
+        {
+            component[v] = uf.root(v);
+        }
+
+        std::vector<std::vector<uint32_t>> kept(threads);
+
+        parallelChunks(live.size(), threads, [&](uint t, size_t begin, size_t end)
+        {
+            std::vector<uint32_t>& local = kept[t];
+            for (size_t i = begin; i < end; ++i)
+            {
+                const Edge& edge = graphEdges[live[i]];
+                if (component[edge.from()] != component[edge.to()])
+                {
+                    local.push_back(live[i]);
+                }
+            }
+        });
+
+        live.clear();
+        for (const std::vector<uint32_t>& local: kept)
+        {
+            live.insert(live.end(), local.begin(), local.end());
+        }
+    }
+
+    std::sort(accepted.begin(), accepted.end());
+
+    std::vector<Edge> result;
+    for (uint64_t key: accepted)
+    {
+        result.push_back(graphEdges[static_cast<uint32_t>(key)]);
+    }
+
+    return result;
+}
+
+std::vector<Edge> Boruvka(const Graph& graph, uint threadCount = 0)
+{
+    std::vector<Edge> graphEdges;
+    for (uint v = 0; v < graph.size(); ++v)
+    {
+        for (const Edge& edge: graph.adjacents(v))
+        {
+            if (edge.from() == static_cast<int>(v))
+            {
+                graphEdges.push_back(edge);
+            }
+        }
+    }
+
+    return Boruvka(graphEdges, graph.size(), threadCount);
+}
+
+
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+std::ostream& operator<<(std::ostream& os, const Edge& v)
+{
+    os << v.from() << " -> " << v.to() << " weight: " << v.weight();
+    return os;
+
+}
+std::ostream& operator<<(std::ostream& os, const std::vector<Edge>& v)
+{
+    os << '[';
+
+    if (!v.empty())
+    {
+        os << v[0];
+
+        for (auto it = v.begin()+1; it != v.end(); ++it)
+        {
+            os << ", " << *it;
+        }
+    }
+    os << ']';
+    return os;
+}
+
+bool sameEdges(const std::vector<Edge>& left, const std::vector<Edge>& right)
+{
+    if (left.size() != right.size())
+    {
+        return false;
+    }
+
+    for (uint i = 0; i < left.size(); ++i)
+    {
+        if (left[i].from() != right[i].from() || left[i].to() != right[i].to()
+            || left[i].weight() != right[i].weight())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+class Test: public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE( Test ); 
+
+    CPPUNIT_TEST( test1 );
+    CPPUNIT_TEST( test2 );
+    CPPUNIT_TEST( test3 );
+    CPPUNIT_TEST( test4 );
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void test1();
+    void test2();
+    void test3();
+    void test4();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( Test );
+
+std::vector<Edge> testEdges()
+{
+    std::vector<Edge> vector;
+
+    vector.emplace_back(0, 7, 16);
+    vector.emplace_back(2, 3, 17);
+    vector.emplace_back(1, 7, 19);
+    vector.emplace_back(3, 6, 52);
+    vector.emplace_back(0, 2, 26);
+    vector.emplace_back(5, 7, 28);
+    vector.emplace_back(1, 3, 29);
+    vector.emplace_back(1, 5, 32);
+    vector.emplace_back(2, 7, 34);
+    vector.emplace_back(4, 5, 35);
+    vector.emplace_back(4, 7, 37);
+    vector.emplace_back(1, 2, 36);
+    vector.emplace_back(0, 4, 38);
+    vector.emplace_back(6, 2, 40);
+    vector.emplace_back(6, 4, 93);
+
+    return vector;
+}
+
+void Test::test1()
+{
+    std::vector<Edge> result = Boruvka(testEdges(), 8);
+
+    std::vector<Edge> expect;
+    expect.emplace_back(0, 7, 16);
+    expect.emplace_back(2, 3, 17);
+    expect.emplace_back(1, 7, 19);
+    expect.emplace_back(0, 2, 26);
+    expect.emplace_back(5, 7, 28);
+    expect.emplace_back(4, 5, 35);
+    expect.emplace_back(6, 2, 40);
+
+    CPPUNIT_ASSERT(sameEdges(expect, result));
+}
+
+void Test::test2()
+{
+    Graph graph(8);
+    for (const Edge& e: testEdges())
+    {
+        graph.add(e);
+    }
+
+    std::vector<Edge> result = Boruvka(graph);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(7), result.size());
+
+    int total = 0;
+    for (const Edge& e: result)
+    {
+        total += e.weight();
+    }
+    CPPUNIT_ASSERT_EQUAL(181, total);
+}
+
+void Test::test3()
+{
+    // a square with equal weights: the tie goes to the earlier edge
+    std::vector<Edge> vector;
+    vector.emplace_back(0, 1, 1);
+    vector.emplace_back(1, 2, 1);
+    vector.emplace_back(2, 3, 1);
+    vector.emplace_back(3, 0, 1);
+    vector.emplace_back(4, 5, 2);
+
+    std::vector<Edge> result = Boruvka(vector, 6);
+
+    std::vector<Edge> expect;
+    expect.emplace_back(0, 1, 1);
+    expect.emplace_back(1, 2, 1);
+    expect.emplace_back(2, 3, 1);
+    expect.emplace_back(4, 5, 2);
+
+    CPPUNIT_ASSERT(sameEdges(expect, result));
+}
+
+void Test::test4()
+{
+    const uint size = 2000;
+    std::vector<Edge> vector;
+
+    uint32_t seed = 7;
+    for (uint i = 0; i < 40000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        int from = (seed >> 8) % size;
+        seed = seed * 1103515245 + 12345;
+        int to = (seed >> 8) % size;
+        seed = seed * 1103515245 + 12345;
+        vector.emplace_back(from, to, (seed >> 8) % 50);
+    }
+
+    // Kruskal with a stable sort
+    std::vector<Edge> sorted = vector;
+    std::stable_sort(sorted.begin(), sorted.end());
+    std::vector<Edge> expect;
+    UnionFind uf(size);
+    for (const Edge& e: sorted)
+    {
+        if (!uf.isConnected(e.from(), e.to()))
+        {
+            uf.connect(e.from(), e.to());
+            expect.push_back(e);
+        }
+    }
+
+    CPPUNIT_ASSERT(sameEdges(expect, Boruvka(vector, size, 1)));
+    CPPUNIT_ASSERT(sameEdges(expect, Boruvka(vector, size, 4)));
+}
+
+int main()
+{
+    CppUnit::TextUi::TestRunner runner;
+    CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+    runner.addTest( registry.makeTest() );
+    runner.run();
+    return 0;
+}
@@ -0,0 +1,369 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <assert.h>
+#include <cstdlib>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+typedef unsigned int uint;
+
+class Edge
+{
+    public:
+    Edge(int from, int to, int weight)
+        : m_from(from)
+        , m_to(to)
+        , m_weight(weight)
+    {
+    }
+
+    int from() const
+    {
+        return m_from; 
+    }
+
+    int to() const
+    {
+        return m_to; 
+    }
+
+    int other(int vertex) const
+    {
+        assert(vertex == to() || vertex == from());
+        return vertex == m_to ? m_from : m_to;
+    }
+
+    int weight() const
+    {
+        return m_weight; 
+    }
+
+private:
+    int m_from, m_to, m_weight;
+
+};
+
+
+bool operator==(const Edge& left, const Edge& right)
+{
+    return left.weight() == right.weight();
+}
+
+bool operator<(const Edge& left, const Edge& right)
+{
+    return left.weight() < right.weight();
+}
+
+
+// weight of a missing edge, and the value of vertices already in the tree
+const int NO_EDGE = std::numeric_limits<int>::max();
+
+// index of the smallest value, the lowest index on ties
+int argMinScalar(const int* values, int size)
+{
+    int best = 0;
+    for (int i = 1; i < size; ++i)
+    {
+        if (values[i] < values[best])
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Vectorized argMin: one pass of lane-wise minimums, a horizontal
+// reduction, then a compare pass for the first lane holding the minimum.
+int argMin(const int* values, int size)
+{
+    int i = 0;
+    int minimum = NO_EDGE;
+
+#if defined(__AVX512F__)
+    __m512i best = _mm512_set1_epi32(NO_EDGE);
+    for (; i + 16 <= size; i += 16)
+    {
+        best = _mm512_min_epi32(best, _mm512_loadu_si512(values + i));
+    }
+    minimum = _mm512_reduce_min_epi32(best);
+#elif defined(__AVX2__)
+    __m256i best = _mm256_set1_epi32(NO_EDGE);
+    for (; i + 8 <= size; i += 8)
+    {
+        best = _mm256_min_epi32(best, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+    }
+    __m128i half = _mm_min_epi32(_mm256_castsi256_si128(best), _mm256_extracti128_si256(best, 1));
+    half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    minimum = _mm_cvtsi128_si32(half);
+#endif
+
+    for (int j = i; j < size; ++j)
+    {
+        minimum = std::min(minimum, values[j]);
+    }
+
+    int j = 0;
+#if defined(__AVX512F__)
+    __m512i target = _mm512_set1_epi32(minimum);
+    for (; j + 16 <= i; j += 16)
+    {
+        __mmask16 mask = _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(values + j), target);
+        if (mask)
+        {
+            return j + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__AVX2__)
+    __m256i target = _mm256_set1_epi32(minimum);
+    for (; j + 8 <= i; j += 8)
+    {
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + j)), target);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+        if (mask)
+        {
+            return j + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (; j < size; ++j)
+    {
+        if (values[j] == minimum)
+        {
+            return j;
+        }
+    }
+    return 0;
+}
+
+// O(V^2) Prim for dense graphs: no heap, only the flat minWeight/parent
+// arrays. distance(u, v) returns the weight of u - v or NO_EDGE.
+// Stops early on a disconnected graph, returning the tree of vertex 0.
+template <class Distance>
+std::vector<Edge> DensePrim(int size, Distance distance)
+{
+    std::vector<Edge> result;
+    if (size == 0)
+    {
+        return result;
+    }
+
+    std::vector<int> minWeight(size, NO_EDGE);
+    std::vector<int> parent(size, -1);
+    std::vector<bool> attached(size, false);
+
+    int vertex = 0;
+    attached[vertex] = true;
+
+    for (int counter = size - 1; counter != 0; --counter)
+    {
+        for (int v = 0; v < size; ++v)
+        {
+            if (!attached[v])
+            {
+                int weight = distance(vertex, v);
+                if (weight < minWeight[v])
+                {
+                    minWeight[v] = weight;
+                    parent[v] = vertex;
+                }
+            }
+        }
+
+        vertex = argMin(minWeight.data(), size);
+        if (minWeight[vertex] == NO_EDGE)
+        {
+            break;
+        }
+
+        result.emplace_back(parent[vertex], vertex, minWeight[vertex]);
+        attached[vertex] = true;
+        minWeight[vertex] = NO_EDGE;
+    }
+
+    return result;
+}
+
+// row-major size x size adjacency matrix, NO_EDGE for missing edges
+std::vector<Edge> DensePrim(const std::vector<int>& matrix, int size)
+{
+    assert(matrix.size() == static_cast<size_t>(size) * size);
+
+    const int* data = matrix.data();
+    return DensePrim(size, [data, size](int from, int to)
+    {
+        return data[static_cast<size_t>(from) * size + to];
+    });
+}
+
+
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+std::ostream& operator<<(std::ostream& os, const Edge& v)
+{
+    os << v.from() << " -> " << v.to() << " weight: " << v.weight();
+    return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const std::vector<Edge>& v)
+{
+    os << '[';
+
+    if (!v.empty())
+    {
+        os << v[0];
+
+        for (auto it = v.begin()+1; it != v.end(); ++it)
+        {
+            os << ", " << *it;
+        }
+    }
+    os << ']';
+    return os;
+}
+
+
+class Test: public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE( Test ); 
+
+    CPPUNIT_TEST( test1 );
+    CPPUNIT_TEST( test2 );
+    CPPUNIT_TEST( test3 );
+    CPPUNIT_TEST( test4 );
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void test1();
+    void test2();
+    void test3();
+    void test4();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( Test );
+
+void Test::test1()
+{
+    std::vector<Edge> vector;
+
+    vector.emplace_back(0, 2, 26);
+    vector.emplace_back(0, 4, 38);
+    vector.emplace_back(0, 7, 16);
+    vector.emplace_back(1, 7, 19);
+    vector.emplace_back(1, 3, 29);
+    vector.emplace_back(1, 5, 32);
+    vector.emplace_back(1, 2, 36);
+    vector.emplace_back(2, 3, 17);
+    vector.emplace_back(2, 7, 34);
+    vector.emplace_back(3, 6, 52);
+    vector.emplace_back(4, 5, 35);
+    vector.emplace_back(4, 7, 37);
+    vector.emplace_back(5, 7, 28);
+    vector.emplace_back(6, 2, 40);
+    vector.emplace_back(6, 4, 93);
+
+    std::vector<int> matrix(8 * 8, NO_EDGE);
+    for (const Edge& e: vector)
+    {
+        matrix[e.from() * 8 + e.to()] = e.weight();
+        matrix[e.to() * 8 + e.from()] = e.weight();
+    }
+
+    std::vector<Edge> result = DensePrim(matrix, 8);
+    std::sort(result.begin(), result.end());
+
+    std::vector<Edge> expect;
+    expect.emplace_back(0, 7, 16);
+    expect.emplace_back(1, 7, 19);
+    expect.emplace_back(0, 2, 26);
+    expect.emplace_back(2, 3, 17);
+    expect.emplace_back(5, 7, 28);
+    expect.emplace_back(4, 5, 35);
+    expect.emplace_back(6, 2, 40);
+
+    std::sort(expect.begin(), expect.end());
+
+    CPPUNIT_ASSERT_EQUAL(expect, result);
+}
+
+void Test::test2()
+{
+    // points on a line: the MST links neighbours, total = span
+    std::vector<int> position = {40, 3, 17, 90, 0, 61, 25, 8, 77, 52, 33, 12, 70, 99, 45, 86, 21, 58};
+    const int size = position.size();
+
+    std::vector<Edge> result = DensePrim(size, [&position](int from, int to)
+    {
+        return std::abs(position[from] - position[to]);
+    });
+
+    CPPUNIT_ASSERT_EQUAL(size_t(size - 1), result.size());
+
+    int total = 0;
+    for (const Edge& e: result)
+    {
+        total += e.weight();
+    }
+    CPPUNIT_ASSERT_EQUAL(99, total);
+}
+
+void Test::test3()
+{
+    uint32_t seed = 5;
+    for (int size = 1; size < 80; ++size)
+    {
+        std::vector<int> values(size);
+        for (int& value: values)
+        {
+            seed = seed * 1103515245 + 12345;
+            value = (seed >> 8) % 20 - 5;
+        }
+
+        CPPUNIT_ASSERT_EQUAL(argMinScalar(values.data(), size), argMin(values.data(), size));
+
+        std::vector<int> unset(size, NO_EDGE);
+        CPPUNIT_ASSERT_EQUAL(0, argMin(unset.data(), size));
+    }
+}
+
+void Test::test4()
+{
+    // 0 - 1 - 2 and 3 - 4 are not connected
+    std::vector<int> matrix(5 * 5, NO_EDGE);
+    auto link = [&matrix](int from, int to, int weight)
+    {
+        matrix[from * 5 + to] = weight;
+        matrix[to * 5 + from] = weight;
+    };
+    link(0, 1, 4);
+    link(1, 2, 2);
+    link(0, 2, 9);
+    link(3, 4, 1);
+
+    std::vector<Edge> result = DensePrim(matrix, 5);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(2), result.size());
+    CPPUNIT_ASSERT_EQUAL(1, result[1].from());
+    CPPUNIT_ASSERT_EQUAL(2, result[1].to());
+}
+
+int main()
+{
+    CppUnit::TextUi::TestRunner runner;
+    CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+    runner.addTest( registry.makeTest() );
+    runner.run();
+    return 0;
+}
@@ -0,0 +1,601 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <assert.h>
+
+using namespace std;
+
+typedef unsigned int uint;
+
+class Edge
+{
+    public:
+    Edge(int from, int to, int weight)
+        : m_from(from)
+        , m_to(to)
+        , m_weight(weight)
+    {
+    }
+
+    int from() const
+    {
+        return m_from; 
+    }
+
+    int to() const
+    {
+        return m_to; 
+    }
+
+    int other(int vertex) const
+    {
+        assert(vertex == to() || vertex == from());
+        return vertex == m_to ? m_from : m_to;
+    }
+
+    int weight() const
+    {
+        return m_weight; 
+    }
+
+    void setWeight(int weight)
+    {
+        m_weight = weight;
+    }
+
+private:
+    int m_from, m_to, m_weight;
+
+};
+
+
+bool operator==(const Edge& left, const Edge& right)
+{
+    return left.weight() == right.weight();
+}
+
+bool operator<(const Edge& left, const Edge& right)
+{
+    return left.weight() < right.weight();
+}
+
+
+// Link-cut tree keeping, for every preferred path, the node with the
+// largest value. Vertices and edges are both nodes: an edge u-v is stored
+// as u - e - v, so a path maximum is the heaviest edge on the tree path.
+class LinkCutTree
+{
+    struct Node
+    {
+        int child[2];
+        int parent;
+        bool reversed;
+        int value;
+        int maxNode;
+    };
+
+public:
+    LinkCutTree()
+        : m_Nodes()
+    {}
+
+    int add(int value)
+    {
+        Node node = {{-1, -1}, -1, false, value, static_cast<int>(m_Nodes.size())};
+        m_Nodes.push_back(node);
+        return node.maxNode;
+    }
+
+    int value(int x) const
+    {
+        return m_Nodes[x].value;
+    }
+
+    void setValue(int x, int value)
+    {
+        access(x);
+        m_Nodes[x].value = value;
+        update(x);
+    }
+
+    void link(int x, int y)
+    {
+        makeRoot(x);
+        m_Nodes[x].parent = y;
+    }
+
+    void cut(int x, int y)
+    {
+        makeRoot(x);
+        access(y);
+        // y is the splay root now and x, its path predecessor, its left child
+        assert(m_Nodes[y].child[0] == x && m_Nodes[x].child[1] == -1);
+        m_Nodes[y].child[0] = -1;
+        m_Nodes[x].parent = -1;
+        update(y);
+    }
+
+    bool isConnected(int x, int y)
+    {
+        return x == y || findRoot(x) == findRoot(y);
+    }
+
+    // node holding the largest value on the tree path x .. y
+    int pathMax(int x, int y)
+    {
+        makeRoot(x);
+        access(y);
+        return m_Nodes[y].maxNode;
+    }
+
+private:
+    bool isSplayRoot(int x) const
+    {
+        int p = m_Nodes[x].parent;
+        return p == -1 || (m_Nodes[p].child[0] != x && m_Nodes[p].child[1] != x);
+    }
+
+    void push(int x)
+    {
+        Node& node = m_Nodes[x];
+        if (node.reversed)
+        {
+            std::swap(node.child[0], node.child[1]);
+            for (int c: node.child)
+            {
+                if (c != -1)
+                {
+                    m_Nodes[c].reversed = !m_Nodes[c].reversed;
+                }
+            }
+            node.reversed = false;
+        }
+    }
+
+    void update(int x)
+    {
+        Node& node = m_Nodes[x];
+        node.maxNode = x;
+        for (int c: node.child)
+        {
+            if (c != -1 && m_Nodes[m_Nodes[c].maxNode].value > m_Nodes[node.maxNode].value)
+            {
+                node.maxNode = m_Nodes[c].maxNode;
+            }
+        }
+    }
+
+    void rotate(int x)
+    {
+        int p = m_Nodes[x].parent;
+        int g = m_Nodes[p].parent;
+        int side = m_Nodes[p].child[1] == x ? 1 : 0;
+        int moved = m_Nodes[x].child[1 - side];
+
+        if (!isSplayRoot(p))
+        {
+            m_Nodes[g].child[m_Nodes[g].child[1] == p ? 1 : 0] = x;
+        }
+        m_Nodes[x].parent = g;
+
+        m_Nodes[x].child[1 - side] = p;
+        m_Nodes[p].parent = x;
+
+        m_Nodes[p].child[side] = moved;
+        if (moved != -1)
+        {
+            m_Nodes[moved].parent = p;
+        }
+
+        update(p);
+        update(x);
+    }
+
+    void splay(int x)
+    {
+        m_Path.clear();
+        for (int y = x; ; y = m_Nodes[y].parent)
+        {
+            m_Path.push_back(y);
+            if (isSplayRoot(y)) break;
+        }
+        for (auto it = m_Path.rbegin(); it != m_Path.rend(); ++it)
+        {
+            push(*it);
+        }
+
+        while (!isSplayRoot(x))
+        {
+            int p = m_Nodes[x].parent;
+            if (!isSplayRoot(p))
+            {
+                int g = m_Nodes[p].parent;
+                bool zigzig = (m_Nodes[g].child[0] == p) == (m_Nodes[p].child[0] == x);
+                rotate(zigzig ? p : x);
+            }
+            rotate(x);
+        }
+    }
+
+    // makes the root .. x path preferred and x the root of its splay tree
+    void access(int x)
+    {
+        int last = -1;
+        for (int y = x; y != -1; y = m_Nodes[y].parent)
+        {
+            splay(y);
+            m_Nodes[y].child[1] = last;
+            update(y);
+            last = y;
+        }
+        splay(x);
+    }
+
+    void makeRoot(int x)
+    {
+        access(x);
+        m_Nodes[x].reversed = !m_Nodes[x].reversed;
+        push(x);
+    }
+
+    int findRoot(int x)
+    {
+        access(x);
+        while (true)
+        {
+            push(x);
+            if (m_Nodes[x].child[0] == -1) break;
+            x = m_Nodes[x].child[0];
+        }
+        splay(x);
+        return x;
+    }
+
+    std::vector<Node> m_Nodes;
+    std::vector<int> m_Path;
+};
+
+
+// Minimum spanning forest maintained under edge insertions and weight
+// decreases. A new (or cheaper) edge u-v either joins two trees or
+// replaces the heaviest edge of the tree path u .. v when it is lighter;
+// both cases cost O(log V) amortized link-cut tree operations.
+class DynamicMst
+{
+public:
+    explicit DynamicMst(uint size)
+        : m_Size(size)
+        , m_Edges()
+        , m_InTree()
+        , m_Tree()
+        , m_Weight(0)
+    {
+        for (uint v = 0; v < size; ++v)
+        {
+            m_Tree.add(std::numeric_limits<int>::min());
+        }
+    }
+
+    // returns the id of the edge, used by decreaseWeight
+    int insert(const Edge& edge)
+    {
+        int id = m_Edges.size();
+
+        m_Edges.push_back(edge);
+        m_InTree.push_back(false);
+        m_Tree.add(edge.weight());
+
+        offer(id);
+        return id;
+    }
+
+    void decreaseWeight(int id, int weight)
+    {
+        Edge& edge = m_Edges[id];
+        assert(weight <= edge.weight());
+
+        if (m_InTree[id])
+        {
+            m_Weight -= edge.weight() - weight;
+            edge.setWeight(weight);
+            m_Tree.setValue(node(id), weight);
+        }
+        else
+        {
+            edge.setWeight(weight);
+            m_Tree.setValue(node(id), weight);
+            offer(id);
+        }
+    }
+
+    bool inTree(int id) const
+    {
+        return m_InTree[id];
+    }
+
+    long long weight() const
+    {
+        return m_Weight;
+    }
+
+    std::vector<Edge> edges() const
+    {
+        std::vector<Edge> result;
+        for (uint id = 0; id < m_Edges.size(); ++id)
+        {
+            if (m_InTree[id])
+            {
+                result.push_back(m_Edges[id]);
+            }
+        }
+        return result;
+    }
+
+private:
+    int node(int id) const
+    {
+        return m_Size + id;
+    }
+
+    void offer(int id)
+    {
+        const Edge& edge = m_Edges[id];
+        if (edge.from() == edge.to())
+        {
+            return;
+        }
+
+        if (m_Tree.isConnected(edge.from(), edge.to()))
+        {
+            int heaviest = m_Tree.pathMax(edge.from(), edge.to());
+            if (m_Tree.value(heaviest) <= edge.weight())
+            {
+                return;
+            }
+
+            int replaced = heaviest - m_Size;
+            const Edge& old = m_Edges[replaced];
+            m_Tree.cut(old.from(), heaviest);
+            m_Tree.cut(heaviest, old.to());
+            m_InTree[replaced] = false;
+            m_Weight -= old.weight();
+        }
+
+        m_Tree.link(edge.from(), node(id));
+        m_Tree.link(node(id), edge.to());
+        m_InTree[id] = true;
+        m_Weight += edge.weight();
+    }
+
+    uint m_Size;
+    std::vector<Edge> m_Edges;
+    std::vector<bool> m_InTree;
+    LinkCutTree m_Tree;
+    long long m_Weight;
+};
+
+
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+std::ostream& operator<<(std::ostream& os, const Edge& v)
+{
+    os << v.from() << " -> " << v.to() << " weight: " << v.weight();
+    return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const std::vector<Edge>& v)
+{
+    os << '[';
+
+    if (!v.empty())
+    {
+        os << v[0];
+
+        for (auto it = v.begin()+1; it != v.end(); ++it)
+        {
+            os << ", " << *it;
+        }
+    }
+    os << ']';
+    return os;
+}
+
+// reference: minimum spanning forest weight recomputed from scratch
+long long kruskalWeight(std::vector<Edge> edges, uint size)
+{
+    std::vector<int> parent(size);
+    for (uint i = 0; i < size; ++i)
+    {
+        parent[i] = i;
+    }
+
+    auto root = [&parent](int v)
+    {
+        while (parent[v] != v)
+        {
+            v = parent[v] = parent[parent[v]];
+        }
+        return v;
+    };
+
+    std::sort(edges.begin(), edges.end());
+
+    long long total = 0;
+    for (const Edge& e: edges)
+    {
+        int r1 = root(e.from());
+        int r2 = root(e.to());
+        if (r1 != r2)
+        {
+            parent[r1] = r2;
+            total += e.weight();
+        }
+    }
+    return total;
+}
+
+
+class Test: public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE( Test ); 
+
+    CPPUNIT_TEST( test1 );
+    CPPUNIT_TEST( test2 );
+    CPPUNIT_TEST( test3 );
+    CPPUNIT_TEST( test4 );
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void test1();
+    void test2();
+    void test3();
+    void test4();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( Test );
+
+std::vector<Edge> testEdges()
+{
+    std::vector<Edge> vector;
+
+    vector.emplace_back(0, 2, 26);
+    vector.emplace_back(0, 4, 38);
+    vector.emplace_back(0, 7, 16);
+
+    vector.emplace_back(1, 7, 19);
+    vector.emplace_back(1, 3, 29);
+    vector.emplace_back(1, 5, 32);
+    vector.emplace_back(1, 2, 36);
+
+    vector.emplace_back(2, 3, 17);
+    vector.emplace_back(2, 7, 34);
+
+    vector.emplace_back(3, 6, 52);
+
+    vector.emplace_back(4, 5, 35);
+    vector.emplace_back(4, 7, 37);
+
+    vector.emplace_back(5, 7, 28);
+
+    vector.emplace_back(6, 2, 40);
+    vector.emplace_back(6, 4, 93);
+
+    return vector;
+}
+
+void Test::test1()
+{
+    DynamicMst mst(8);
+    for (const Edge& e: testEdges())
+    {
+        mst.insert(e);
+    }
+
+    std::vector<Edge> result = mst.edges();
+    std::sort(result.begin(), result.end());
+
+    std::vector<Edge> expect;
+    expect.emplace_back(0, 7, 16);
+    expect.emplace_back(1, 7, 19);
+    expect.emplace_back(0, 2, 26);
+    expect.emplace_back(2, 3, 17);
+    expect.emplace_back(5, 7, 28);
+    expect.emplace_back(4, 5, 35);
+    expect.emplace_back(6, 2, 40);
+
+    std::sort(expect.begin(), expect.end());
+
+    CPPUNIT_ASSERT_EQUAL(expect, result);
+    CPPUNIT_ASSERT_EQUAL(181LL, mst.weight());
+}
+
+void Test::test2()
+{
+    DynamicMst mst(8);
+    std::vector<int> ids;
+    for (const Edge& e: testEdges())
+    {
+        ids.push_back(mst.insert(e));
+    }
+
+    // 6 - 4 at 93 is not in the tree; at 30 it replaces 6 - 2 (40)
+    int id = ids.back();
+    CPPUNIT_ASSERT(!mst.inTree(id));
+
+    mst.decreaseWeight(id, 30);
+
+    CPPUNIT_ASSERT(mst.inTree(id));
+    CPPUNIT_ASSERT(!mst.inTree(ids[13]));
+    CPPUNIT_ASSERT_EQUAL(171LL, mst.weight());
+}
+
+void Test::test3()
+{
+    DynamicMst mst(8);
+    std::vector<int> ids;
+    for (const Edge& e: testEdges())
+    {
+        ids.push_back(mst.insert(e));
+    }
+
+    // a tree edge getting cheaper stays in the tree
+    mst.decreaseWeight(ids[10], 1);
+    CPPUNIT_ASSERT(mst.inTree(ids[10]));
+    CPPUNIT_ASSERT_EQUAL(147LL, mst.weight());
+
+    // and it is now the lightest edge on every cycle through it
+    mst.insert(Edge(4, 5, 2));
+    CPPUNIT_ASSERT_EQUAL(147LL, mst.weight());
+
+    mst.insert(Edge(3, 6, 3));
+    CPPUNIT_ASSERT_EQUAL(147LL - 40 + 3, mst.weight());
+}
+
+void Test::test4()
+{
+    const uint size = 60;
+    DynamicMst mst(size);
+    std::vector<Edge> edges;
+    std::vector<int> ids;
+
+    uint32_t seed = 3;
+    auto random = [&seed]()
+    {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) & 0xffff;
+    };
+
+    for (uint step = 0; step < 2000; ++step)
+    {
+        if (edges.empty() || random() % 3 != 0)
+        {
+            Edge e(random() % size, random() % size, random() % 1000);
+            edges.push_back(e);
+            ids.push_back(mst.insert(e));
+        }
+        else
+        {
+            uint i = random() % edges.size();
+            int weight = edges[i].weight() - random() % 100;
+            edges[i].setWeight(weight);
+            mst.decreaseWeight(ids[i], weight);
+        }
+
+        CPPUNIT_ASSERT_EQUAL(kruskalWeight(edges, size), mst.weight());
+    }
+}
+
+int main()
+{
+    CppUnit::TextUi::TestRunner runner;
+    CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+    runner.addTest( registry.makeTest() );
+    runner.run();
+    return 0;
+}
@@ -4,6 +4,12 @@
 #include <limits>
 #include <iostream>
 #include <assert.h>
+#include <atomic>
+#include <thread>
+
+#include "../../common/DaryHeap.h"
+#include "../../common/BucketQueue.h"
+#include "../../common/EdgeArrayGraph.h"
 
 using namespace std;
 
@@ -54,56 +60,7 @@ private:
 
 };
 
-class Graph
-{
-    public:
-        Graph(size_t size)
-            : m_Edges(size)
-        {}
-
-        void add(const Edge& edge)
-        {
-            m_Edges[edge.from()].push_back(edge);
-            m_Edges[edge.to()].push_back(edge);
-        }
-
-        size_t size() const
-        {
-            return m_Edges.size();
-        }
-
-        const std::vector<Edge>& adjacents(int vertex) const
-        {
-            return m_Edges[vertex];
-        }
-
-        void deleteEdge(const Edge& e)
-        {
-            std::vector<Edge>& v = m_Edges[e.from()];
-            for (std::vector<Edge>::iterator it = v.begin(); it != v.end(); ++it)
-            {
-               if (it->to() == e.to())
-               {
-                   v.erase(it);
-                   break;
-               } 
-            }
-
-
-            std::vector<Edge>& v1 = m_Edges[e.to()];
-            for (std::vector<Edge>::iterator it = v1.begin(); it != v1.end(); ++it)
-            {
-               if (it->from() == e.from())
-               {
-                   v1.erase(it);
-                   break;
-               } 
-            }
-        }
-
-    private:
-        std::vector<std::vector<Edge>> m_Edges;
-};
+typedef EdgeArrayGraph Graph;
 
 
 bool operator==(const Edge& left, const Edge& right)
@@ -117,260 +74,193 @@ bool operator<(const Edge& left, const Edge& right)
 }
 
 
-class Heap
+// heap entries are keyed by the vertex they lead to
+struct EdgeTarget
 {
-
-private:
-    std::vector<Edge> m_Edges;
-    std::vector<int> m_VertexToPosition;
-
-private:
-
-    int leftIndex(int position)
+    int operator()(const Edge& edge) const
     {
-        return position * 2 + 1;
+        return edge.to();
     }
+};
 
-    int rightIndex(int position)
-    {
-        return position * 2 + 2;
-    }
+typedef DaryHeap<Edge, 4, std::less<Edge>, KeyIndex<EdgeTarget>> Heap;
 
-    int parentIndex(int position)
+struct EdgeWeight
+{
+    unsigned operator()(const Edge& edge) const
     {
-        return (position-1)/2;
+        return edge.weight();
     }
+};
 
-//-----------------------------------------------
-    Edge& left(int position)
-    {
-        return m_Edges[leftIndex(position)];
-    }
+// for small non-negative integer weights: EagerPrim(graph, bucketQueue)
+typedef BucketQueue<Edge, EdgeWeight, KeyIndex<EdgeTarget>> EdgeBucketQueue;
 
-    Edge& right(int position)
-    {
-        return m_Edges[rightIndex(position)];
-    }
+std::ostream& operator<<(std::ostream& os, const Edge& v)
+{
+    os << v.from() << " -> " << v.to() << " weight: " << v.weight();
+    return os;
+}
 
-    Edge& parent(int position)
-    {
-        return m_Edges[parentIndex(position)];
-    }
+std::ostream& operator<<(std::ostream& os, const Heap& heap)
+{
+    const std::vector<Edge>& edges = heap.items();
 
-    bool m_Comparator(const Edge& e1, const Edge& e2)
+    os << "[";
+    if (!edges.empty())
     {
-        return e1 < e2;
-    }
-//---------------------------------------------
+        os << "{from: " << edges[0].from() << ", to: "<< edges[0].to() << '}';
 
-    int size() const
-    {
-        return m_Edges.size();
+        for (uint i = 1; i < edges.size(); ++i)
+        {
+            os << ", {from: " << edges[i].from() << ", to: "<< edges[i].to() << '}';
+        }
     }
+    os << "]";
 
-    void swap(int pos1, int pos2)
-    {
-        Edge& e1 = m_Edges[pos1];
-        Edge& e2 = m_Edges[pos2];
-        std::swap(e1, e2);
-        std::swap(m_VertexToPosition[e1.to()], m_VertexToPosition[e2.to()]);
-    }
+    return os;
+}
 
-    int sinkOnce(int position)
+// Grows the spanning tree of root's component. Queue is an indexed
+// priority queue of Edge keyed by target vertex, with room for graph.size()
+// keys (Heap or EdgeBucketQueue); it is empty again on return.
+template <class Queue>
+std::vector<Edge> EagerPrimTree(const Graph& graph, int root, Queue& heap, std::vector<char>& attached)
+{
+    std::vector<Edge> result;
+
+    int vertex = root;
+    attached[vertex] = true;
+
+    while (true)
     {
-        int currentPosition = position;
-        if (leftIndex(position) < size())
+        for (uint32_t id: graph.adjacents(vertex))
         {
-            if (m_Comparator(left(position), m_Edges[position]))
+            int next = graph.other(id, vertex);
+            if (attached[next] == false)
             {
-                swap(leftIndex(position), position);
-                currentPosition = leftIndex(position);
+                heap.pushOrDecrease(Edge(vertex, next, graph.weight(id)));
             }
         }
 
-        if (rightIndex(position) < size())
+        if (heap.empty())
         {
-            if (m_Comparator(right(position), m_Edges[position]))
-            {
-                swap(rightIndex(position), position);
-
-                if (position == currentPosition) // an element wasn't swapped
-                {
-                    currentPosition = rightIndex(position);
-                }
-            }
+            break;
         }
 
-        return currentPosition;
-    }
+        Edge e = heap.pop();
 
-    int promoteOnce(int position)
-    {
-        if (m_Comparator(m_Edges[position], parent(position)))
-        {
-            swap(position, parentIndex(position));
-            return parentIndex(position);
-        }
-        return position;
+        result.push_back(e);
+        vertex = e.to();
+        attached[vertex] = true;
     }
 
+    return result;
+}
 
-    int sink(int position)
+// spanning tree of vertex 0's component
+template <class Queue>
+std::vector<Edge> EagerPrim(const Graph& graph, Queue& heap)
+{
+    if (graph.size() == 0)
     {
-        int nextPosition;
-        while (position != (nextPosition = sinkOnce(position)))
-        {
-            position = nextPosition;
-        }
-
-        return position;
+        return std::vector<Edge>();
     }
 
-    int promote(int position)
-    {
-        int nextPosition;
-        while (position != (nextPosition = promoteOnce(position)))
-        {
-            position = nextPosition;
-        }
-
-        return position;
-    }
+    std::vector<char> attached(graph.size(), false);
+    return EagerPrimTree(graph, 0, heap, attached);
+}
 
+std::vector<Edge> EagerPrim(const Graph& graph)
+{
+    Heap heap(graph.size());
+    return EagerPrim(graph, heap);
+}
 
-//
-public:
-    explicit Heap(size_t size, uint initialVertex)
-        : m_Edges()
-        , m_VertexToPosition(size, -1)
-    {
-        m_VertexToPosition[initialVertex] = size; // initialize with ...?
-    }
+// smallest vertex of every connected component, in increasing order
+std::vector<int> componentRoots(const Graph& graph)
+{
+    std::vector<int> roots;
+    std::vector<bool> marked(graph.size(), false);
+    std::vector<int> stack;
 
-    bool empty() const
+    for (uint root = 0; root < graph.size(); ++root)
     {
-        return size() == 0;
-    }
+        if (marked[root]) continue;
 
-    void add(const Edge& edge, int from)
-    {
-        int to = edge.other(from);
+        roots.push_back(root);
+        marked[root] = true;
+        stack.push_back(root);
 
-        if (m_VertexToPosition[to] == -1)
+        while (!stack.empty())
         {
-            int pos = m_Edges.size();
-
-            m_Edges.push_back(edge);
-            m_Edges.back().setSourceVertex(from);
-            m_VertexToPosition[m_Edges.back().to()] = pos;
+            int vertex = stack.back();
+            stack.pop_back();
 
-            promote(pos);
-        }
-        else
-        {
-            int hashPosition = m_VertexToPosition[to];
-            if (edge.weight() < m_Edges[hashPosition].weight())
+            for (uint32_t id: graph.adjacents(vertex))
             {
-                m_Edges[hashPosition] = Edge(from, to, edge.weight());
-                promote(hashPosition);
+                int next = graph.other(id, vertex);
+                if (!marked[next])
+                {
+                    marked[next] = true;
+                    stack.push_back(next);
+                }
             }
         }
     }
 
-    Edge pop()
-    {
-        Edge e = m_Edges[0];
-
-        m_VertexToPosition[e.to()] = m_VertexToPosition.size();
-
-        m_Edges[0] = m_Edges.back();
-        m_Edges.pop_back();
-        m_VertexToPosition[m_Edges[0].to()] = 0;
-
-        sink(0);
-
-        return e;
-    }
-
-    const Edge& getEdgeToVertex(int vertex)
-    {
-        return m_Edges[m_VertexToPosition[vertex]];
-    }
-
-    const std::vector<Edge>& getEdges() const
-    {
-        return m_Edges;
-    }
-
-    const std::vector<int>& GetVertexToPos() const
-    {
-        return m_VertexToPosition;
-    }
-
-};
-
-std::ostream& operator<<(std::ostream& os, const Edge& v)
-{
-    os << v.from() << " -> " << v.to() << " weight: " << v.weight();
-    return os;
+    return roots;
 }
 
-std::ostream& operator<<(std::ostream& os, const Heap& heap)
+struct SpanningTree
 {
-    const std::vector<Edge> edges = heap.getEdges();
+    std::vector<Edge> edges;
+    long long weight;
+};
 
-    os << "[";
-    if (!edges.empty())
+// Minimum spanning forest: one tree per connected component, ordered by the
+// component's smallest vertex (an isolated vertex gets an empty tree).
+// Components are handed out to threadCount workers, each reusing one heap.
+std::vector<SpanningTree> EagerPrimForest(const Graph& graph, uint threadCount = 0)
+{
+    if (threadCount == 0)
     {
-        os << "{from: " << edges[0].from() << ", to: "<< edges[0].to() << '}';
-
-        for (uint i = 1; i < edges.size(); ++i)
-        {
-            os << ", {from: " << edges[i].from() << ", to: "<< edges[i].to() << '}';
-        }
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
     }
-    os << "]";
-
-    return os;
-}
-
-std::vector<Edge> EagerPrim(const Graph& graph)
-{
-    std::vector<Edge> result;
 
-    int vertex = 0;
-    Heap heap(graph.size(), vertex);
-    std::vector<bool> attached(graph.size(), false);
-    attached[vertex] = true;
-    int counter = graph.size()-1;
+    std::vector<int> roots = componentRoots(graph);
+    std::vector<SpanningTree> forest(roots.size());
+    std::vector<char> attached(graph.size(), false);
+    std::atomic<size_t> nextComponent(0);
 
-    do
+    auto worker = [&]()
     {
-        const std::vector<Edge>& edges = graph.adjacents(vertex);
-
-        for (const Edge& e: edges)
+        Heap heap(graph.size());
+        size_t component;
+        while ((component = nextComponent++) < roots.size())
         {
-            if (attached[e.other(vertex)] == false)
+            SpanningTree& tree = forest[component];
+            tree.edges = EagerPrimTree(graph, roots[component], heap, attached);
+            tree.weight = 0;
+            for (const Edge& e: tree.edges)
             {
-                heap.add(e, vertex);
+                tree.weight += e.weight();
             }
         }
+    };
 
-        Edge e(-1, -1, -1);
-        do 
-        {
-            e = heap.pop();
-
-        } while (attached[e.to()] && attached[e.from()]);
-        --counter;
-
-        result.push_back(e);
-        vertex = attached[e.to()] ? e.from(): e.to();
-        attached[vertex] = true;
-
-    } while (counter);
+    std::vector<std::thread> workers;
+    for (uint t = 1; t < std::min<size_t>(threadCount, roots.size()); ++t)
+    {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread: workers)
+    {
+        thread.join();
+    }
 
-    return result;
+    return forest;
 }
 
 
@@ -479,44 +369,134 @@ void Test::test1()
 
 void Test::test2()
 {
-    Heap heap(8, 0);
+    Heap heap(8);
 
-    heap.add(Edge(0, 2, 5), 0);
-    heap.add(Edge(0, 4, 5), 0);
-    heap.add(Edge(0, 7, 4), 0);
+    heap.pushOrDecrease(Edge(0, 2, 5));
+    heap.pushOrDecrease(Edge(0, 4, 5));
+    heap.pushOrDecrease(Edge(0, 7, 4));
 
-    const std::vector<int>& pos = heap.GetVertexToPos();
-
-    CPPUNIT_ASSERT(pos[2] != -1);
-    CPPUNIT_ASSERT(pos[4] != -1);
-    CPPUNIT_ASSERT(pos[7] != -1);
+    CPPUNIT_ASSERT(heap.contains(2));
+    CPPUNIT_ASSERT(heap.contains(4));
+    CPPUNIT_ASSERT(heap.contains(7));
 
     Edge e = heap.pop();
 
     Edge expectedEdge(0, 7, 4);
     CPPUNIT_ASSERT_EQUAL(expectedEdge, e);
+    CPPUNIT_ASSERT_EQUAL(7, e.to());
+
+    CPPUNIT_ASSERT(!heap.contains(7));
+    CPPUNIT_ASSERT(heap.contains(2));
+    CPPUNIT_ASSERT(heap.contains(4));
+
+    CPPUNIT_ASSERT(heap.pushOrDecrease(Edge(7, 1, 5)));
+    CPPUNIT_ASSERT(!heap.pushOrDecrease(Edge(7, 2, 5)));
+    CPPUNIT_ASSERT(heap.pushOrDecrease(Edge(7, 4, 3)));
+    CPPUNIT_ASSERT(heap.pushOrDecrease(Edge(7, 5, 4)));
 
+    CPPUNIT_ASSERT_EQUAL(7, heap.get(4).from());
+    CPPUNIT_ASSERT_EQUAL(0, heap.get(2).from());
 
-    CPPUNIT_ASSERT_EQUAL(8, pos[7]);
-    CPPUNIT_ASSERT(pos[2] != -1);
-    CPPUNIT_ASSERT(pos[4] != -1);
+    heap.decrease(Edge(7, 2, 1));
 
+    e = heap.pop();
+    CPPUNIT_ASSERT_EQUAL(2, e.to());
+    CPPUNIT_ASSERT_EQUAL(1, e.weight());
 
-    heap.add(Edge(7, 1, 5), 7);
-    heap.add(Edge(7, 2, 5), 7);
-    heap.add(Edge(7, 4, 4), 7);
-    heap.add(Edge(7, 5, 4), 7);
+    e = heap.pop();
+    CPPUNIT_ASSERT_EQUAL(4, e.to());
+    CPPUNIT_ASSERT_EQUAL(3, e.weight());
 
+    e = heap.pop();
+    CPPUNIT_ASSERT_EQUAL(5, e.to());
+
+    e = heap.pop();
+    CPPUNIT_ASSERT_EQUAL(1, e.to());
+    CPPUNIT_ASSERT(heap.empty());
 }
 
 void Test::test3()
 {
+    std::vector<Edge> vector;
+
+    vector.emplace_back(0, 2, 26);
+    vector.emplace_back(0, 4, 38);
+    vector.emplace_back(0, 7, 16);
+    vector.emplace_back(1, 7, 19);
+    vector.emplace_back(1, 3, 29);
+    vector.emplace_back(1, 5, 32);
+    vector.emplace_back(1, 2, 36);
+    vector.emplace_back(2, 3, 17);
+    vector.emplace_back(2, 7, 34);
+    vector.emplace_back(3, 6, 52);
+    vector.emplace_back(4, 5, 35);
+    vector.emplace_back(4, 7, 37);
+    vector.emplace_back(5, 7, 28);
+    vector.emplace_back(6, 2, 40);
+    vector.emplace_back(6, 4, 93);
+
+    Graph graph(8);
+    for (const Edge& e: vector)
+    {
+        graph.add(e);
+    }
+
+    EdgeBucketQueue queue(100, graph.size());
+    std::vector<Edge> result = EagerPrim(graph, queue);
+    std::vector<Edge> expect = EagerPrim(graph);
+
+    std::sort(result.begin(), result.end());
+    std::sort(expect.begin(), expect.end());
+
+    CPPUNIT_ASSERT_EQUAL(expect, result);
 
+    EdgeBucketQueue bucket(10, 8);
+    bucket.pushOrDecrease(Edge(0, 2, 5));
+    bucket.pushOrDecrease(Edge(0, 4, 5));
+    bucket.pushOrDecrease(Edge(0, 6, 5));
+    bucket.pushOrDecrease(Edge(1, 4, 2));
+    CPPUNIT_ASSERT(!bucket.pushOrDecrease(Edge(1, 2, 9)));
+    CPPUNIT_ASSERT_EQUAL(size_t(3), bucket.size());
+
+    Edge e = bucket.pop();
+    CPPUNIT_ASSERT_EQUAL(4, e.to());
+    CPPUNIT_ASSERT_EQUAL(1, e.from());
+    CPPUNIT_ASSERT(!bucket.contains(4));
+    CPPUNIT_ASSERT_EQUAL(0, bucket.get(2).from());
+    CPPUNIT_ASSERT_EQUAL(0, bucket.get(6).from());
 }
 
 void Test::test4()
 {
-
+    // {0, 1, 2}, {3}, {4, 5, 6, 7} and a last island {8, 9}
+    Graph graph(10);
+    graph.add(Edge(0, 1, 4));
+    graph.add(Edge(1, 2, 2));
+    graph.add(Edge(0, 2, 9));
+    graph.add(Edge(4, 5, 3));
+    graph.add(Edge(5, 6, 1));
+    graph.add(Edge(6, 7, 8));
+    graph.add(Edge(4, 7, 5));
+    graph.add(Edge(4, 6, 7));
+    graph.add(Edge(9, 8, 6));
+
+    std::vector<Edge> first = EagerPrim(graph);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), first.size());
+
+    for (uint threads = 1; threads <= 4; ++threads)
+    {
+        std::vector<SpanningTree> forest = EagerPrimForest(graph, threads);
+
+        CPPUNIT_ASSERT_EQUAL(size_t(4), forest.size());
+        CPPUNIT_ASSERT_EQUAL(6LL, forest[0].weight);
+        CPPUNIT_ASSERT_EQUAL(size_t(2), forest[0].edges.size());
+        CPPUNIT_ASSERT_EQUAL(0LL, forest[1].weight);
+        CPPUNIT_ASSERT(forest[1].edges.empty());
+        CPPUNIT_ASSERT_EQUAL(9LL, forest[2].weight);
+        CPPUNIT_ASSERT_EQUAL(size_t(3), forest[2].edges.size());
+        CPPUNIT_ASSERT_EQUAL(6LL, forest[3].weight);
+        CPPUNIT_ASSERT_EQUAL(9, forest[3].edges[0].to());
+    }
 }
 
 int main()
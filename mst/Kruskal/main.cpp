@@ -3,6 +3,21 @@
 #include <algorithm>
 #include <limits>
 #include <iostream>
+#include <numeric>
+#include <functional>
+#include <thread>
+#include <type_traits>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <queue>
+#include <stdexcept>
+#include <memory>
+#include <atomic>
+
+#include <unistd.h>
+
+#include "../../common/EdgeArrayGraph.h"
 
 using namespace std;
 
@@ -43,56 +58,7 @@ private:
 
 };
 
-class Graph
-{
-    public:
-        Graph(size_t size)
-            : m_Edges(size)
-        {}
-
-        void add(const Edge& edge)
-        {
-            m_Edges[edge.from()].push_back(edge);
-            m_Edges[edge.to()].push_back(edge);
-        }
-
-        size_t size() const
-        {
-            return m_Edges.size();
-        }
-
-        const std::vector<Edge>& adjacents(int vertex) const
-        {
-            return m_Edges[vertex];
-        }
-
-        void deleteEdge(const Edge& e)
-        {
-            std::vector<Edge>& v = m_Edges[e.from()];
-            for (std::vector<Edge>::iterator it = v.begin(); it != v.end(); ++it)
-            {
-               if (it->to() == e.to())
-               {
-                   v.erase(it);
-                   break;
-               } 
-            }
-
-
-            std::vector<Edge>& v1 = m_Edges[e.to()];
-            for (std::vector<Edge>::iterator it = v1.begin(); it != v1.end(); ++it)
-            {
-               if (it->from() == e.from())
-               {
-                   v1.erase(it);
-                   break;
-               } 
-            }
-        }
-
-    private:
-        std::vector<std::vector<Edge>> m_Edges;
-};
+typedef EdgeArrayGraph Graph;
 
 
 
@@ -186,6 +152,440 @@ std::vector<Edge> Kruskal(std::vector<Edge>& graphEdges, uint graphSize)
 }
 
 
+// Edges laid out as separate arrays, so the sort only moves 4-byte keys
+// and indices instead of whole Edge objects.
+struct EdgeBuffer
+{
+    std::vector<uint32_t> weights;
+    std::vector<int> from;
+    std::vector<int> to;
+};
+
+// Maps a signed weight onto an unsigned key with the same ordering.
+inline uint32_t radixKey(int32_t weight)
+{
+    return static_cast<uint32_t>(weight) ^ 0x80000000u;
+}
+
+inline uint32_t radixKey(uint32_t weight)
+{
+    return weight;
+}
+
+// Stable LSD radix sort of 'keys' (8 bits per pass), returning the
+// permutation of indices. Every pass splits the input into contiguous
+// chunks: each thread builds the digit histogram of its chunk, the
+// histograms are turned into per-thread output offsets and then each thread
+// scatters its chunk. Passes where all keys share the digit are skipped.
+std::vector<uint32_t> radixSortedOrder(const std::vector<uint32_t>& keys, uint threadCount = 0)
+{
+    const size_t size = keys.size();
+    const uint radix = 256;
+
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const size_t minChunk = 1 << 16;
+    threadCount = std::max<size_t>(1, std::min<size_t>(threadCount, size / minChunk));
+
+    std::vector<uint32_t> order(size);
+    std::iota(order.begin(), order.end(), 0);
+
+    std::vector<uint32_t> currentKeys(keys);
+    std::vector<uint32_t> nextKeys(size);
+    std::vector<uint32_t> nextOrder(size);
+
+    const size_t chunk = (size + threadCount - 1) / threadCount;
+    std::vector<std::vector<size_t>> offsets(threadCount, std::vector<size_t>(radix));
+
+    auto forEachChunk = [&](const std::function<void(uint, size_t, size_t)>& body)
+    {
+        std::vector<std::thread> workers;
+        for (uint t = 1; t < threadCount; ++t)
+        {
+            workers.emplace_back(body, t, std::min(size, t * chunk), std::min(size, (t + 1) * chunk));
+        }
+        body(0, 0, std::min(size, chunk));
+        for (std::thread& worker: workers)
+        {
+            worker.join();
+        }
+    };
+
+    for (uint shift = 0; shift < 32; shift += 8)
+    {
+        forEachChunk([&](uint t, size_t begin, size_t end)
+        {
+            std::vector<size_t>& histogram = offsets[t];
+            std::fill(histogram.begin(), histogram.end(), 0);
+            for (size_t i = begin; i < end; ++i)
+            {
+                ++histogram[(currentKeys[i] >> shift) & (radix - 1)];
+            }
+        });
+
+        size_t total = 0;
+        bool trivial = false;
+        for (uint digit = 0; digit < radix; ++digit)
+        {
+            size_t count = 0;
+            for (uint t = 0; t < threadCount; ++t)
+            {
+                size_t local = offsets[t][digit];
+                offsets[t][digit] = total + count;
+                count += local;
+            }
+            trivial = trivial || count == size;
+            total += count;
+        }
+
+        if (trivial)
+        {
+            continue;
+        }
+
+        forEachChunk([&](uint t, size_t begin, size_t end)
+        {
+            std::vector<size_t>& position = offsets[t];
+            for (size_t i = begin; i < end; ++i)
+            {
+                size_t target = position[(currentKeys[i] >> shift) & (radix - 1)]++;
+                nextKeys[target] = currentKeys[i];
+                nextOrder[target] = order[i];
+            }
+        });
+
+        currentKeys.swap(nextKeys);
+        order.swap(nextOrder);
+    }
+
+    return order;
+}
+
+template <class EdgeT>
+std::vector<EdgeT> sweepSorted(const std::vector<EdgeT>& graphEdges, const EdgeBuffer& buffer,
+                               const std::vector<uint32_t>& order, uint graphSize)
+{
+    std::vector<EdgeT> result;
+    UnionFind uf(graphSize);
+
+    for (uint32_t index: order)
+    {
+        if (result.size() + 1 >= graphSize)
+        {
+            break;
+        }
+
+        int from = buffer.from[index];
+        int to = buffer.to[index];
+        if (!uf.isConnected(from, to))
+        {
+            uf.connect(from, to);
+            result.push_back(graphEdges[index]);
+        }
+    }
+
+    return result;
+}
+
+template <class EdgeT>
+EdgeBuffer makeEdgeBuffer(const std::vector<EdgeT>& graphEdges)
+{
+    EdgeBuffer buffer;
+    buffer.from.reserve(graphEdges.size());
+    buffer.to.reserve(graphEdges.size());
+
+    for (const EdgeT& edge: graphEdges)
+    {
+        buffer.from.push_back(edge.from());
+        buffer.to.push_back(edge.to());
+    }
+
+    return buffer;
+}
+
+// integral weights of at most 32 bits: radix sort of the weight keys
+template <class EdgeT>
+std::vector<EdgeT> KruskalByIndexImpl(const std::vector<EdgeT>& graphEdges, uint graphSize, std::true_type)
+{
+    typedef typename std::decay<decltype(graphEdges[0].weight())>::type Weight;
+    typedef typename std::conditional<std::is_signed<Weight>::value, int32_t, uint32_t>::type Key;
+
+    EdgeBuffer buffer = makeEdgeBuffer(graphEdges);
+    buffer.weights.reserve(graphEdges.size());
+    for (const EdgeT& edge: graphEdges)
+    {
+        buffer.weights.push_back(radixKey(static_cast<Key>(edge.weight())));
+    }
+
+    std::vector<uint32_t> order = radixSortedOrder(buffer.weights);
+    return sweepSorted(graphEdges, buffer, order, graphSize);
+}
+
+// any other weight: stable comparison sort of the indices
+template <class EdgeT>
+std::vector<EdgeT> KruskalByIndexImpl(const std::vector<EdgeT>& graphEdges, uint graphSize, std::false_type)
+{
+    EdgeBuffer buffer = makeEdgeBuffer(graphEdges);
+
+    std::vector<uint32_t> order(graphEdges.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&graphEdges](uint32_t left, uint32_t right)
+    {
+        return graphEdges[left].weight() < graphEdges[right].weight();
+    });
+
+    return sweepSorted(graphEdges, buffer, order, graphSize);
+}
+
+// Kruskal that leaves the caller's edges untouched: it sorts an index
+// permutation instead. Ties keep the input order. The radix path is chosen
+// at compile time when the edge weight is an integer of at most 32 bits.
+template <class EdgeT>
+std::vector<EdgeT> KruskalByIndex(const std::vector<EdgeT>& graphEdges, uint graphSize)
+{
+    typedef typename std::decay<decltype(std::declval<const EdgeT&>().weight())>::type Weight;
+    typedef std::integral_constant<bool, std::is_integral<Weight>::value && sizeof(Weight) <= 4> IsRadixSortable;
+
+    return KruskalByIndexImpl(graphEdges, graphSize, IsRadixSortable());
+}
+
+
+
+// Kruskal over the shared edge-array graph: the weight array is radix
+// sorted in place of Edge objects, and deleted edges are skipped.
+std::vector<Edge> Kruskal(const Graph& graph)
+{
+    std::vector<uint32_t> keys(graph.edgeCount());
+    for (uint32_t id = 0; id < keys.size(); ++id)
+    {
+        keys[id] = radixKey(static_cast<int32_t>(graph.weight(id)));
+    }
+
+    std::vector<Edge> result;
+    UnionFind uf(graph.size());
+
+    for (uint32_t id: radixSortedOrder(keys))
+    {
+        if (result.size() + 1 >= graph.size())
+        {
+            break;
+        }
+
+        if (!graph.isDeleted(id) && !uf.isConnected(graph.from(id), graph.to(id)))
+        {
+            uf.connect(graph.from(id), graph.to(id));
+            result.emplace_back(graph.from(id), graph.to(id), graph.weight(id));
+        }
+    }
+
+    return result;
+}
+
+// On-disk edge layout used by ExternalKruskal: three native int32 per edge.
+struct EdgeRecord
+{
+    int32_t from;
+    int32_t to;
+    int32_t weight;
+};
+
+// Sequential reader of EdgeRecords that keeps only 'bufferEdges' in memory.
+class EdgeRecordReader
+{
+public:
+    EdgeRecordReader(const std::string& fileName, size_t bufferEdges)
+        : m_FileName(fileName)
+        , m_Stream(fileName.c_str(), std::ios::binary)
+        , m_Buffer(std::max<size_t>(1, bufferEdges))
+        , m_Position(0)
+        , m_Size(0)
+    {
+        if (!m_Stream)
+        {
+            throw std::runtime_error("cannot open edge file " + fileName);
+        }
+    }
+
+    bool next(EdgeRecord& record)
+    {
+        if (m_Position == m_Size)
+        {
+            m_Size = read(m_Buffer.data(), m_Buffer.size());
+            m_Position = 0;
+            if (m_Size == 0)
+            {
+                return false;
+            }
+        }
+
+        record = m_Buffer[m_Position++];
+        return true;
+    }
+
+    // Returns the number of whole records read, 0 at end of file. A read
+    // error or a trailing partial record throws instead of ending the file.
+    size_t read(EdgeRecord* records, size_t count)
+    {
+        m_Stream.read(reinterpret_cast<char*>(records), count * sizeof(EdgeRecord));
+        if (m_Stream.bad())
+        {
+            throw std::runtime_error("cannot read edge file " + m_FileName);
+        }
+        if (m_Stream.gcount() % sizeof(EdgeRecord) != 0)
+        {
+            throw std::runtime_error("truncated edge record in " + m_FileName);
+        }
+        return m_Stream.gcount() / sizeof(EdgeRecord);
+    }
+
+private:
+    std::string m_FileName;
+    std::ifstream m_Stream;
+    std::vector<EdgeRecord> m_Buffer;
+    size_t m_Position;
+    size_t m_Size;
+};
+
+// Owns the names of the sorted run files and removes them on destruction,
+// so they are cleaned up on every exit path, including exceptions.
+class RunFiles
+{
+public:
+    RunFiles() = default;
+    RunFiles(const RunFiles&) = delete;
+    RunFiles& operator=(const RunFiles&) = delete;
+
+    ~RunFiles()
+    {
+        for (const std::string& name: m_Names)
+        {
+            std::remove(name.c_str());
+        }
+    }
+
+    void add(const std::string& name) { m_Names.push_back(name); }
+    const std::vector<std::string>& names() const { return m_Names; }
+    size_t size() const { return m_Names.size(); }
+
+private:
+    std::vector<std::string> m_Names;
+};
+
+// Splits the edge file into runs of at most 'runEdges' edges, each sorted
+// by weight (stable, through the radix sort) and written to its own file.
+void writeSortedRuns(const std::string& edgeFile, size_t runEdges, const std::string& runPrefix, RunFiles& runs)
+{
+    EdgeRecordReader reader(edgeFile, 0);
+    std::vector<EdgeRecord> records(runEdges);
+    std::vector<uint32_t> keys;
+
+    size_t count;
+    while ((count = reader.read(records.data(), runEdges)) != 0)
+    {
+        keys.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            keys[i] = radixKey(records[i].weight);
+        }
+
+        std::string runName = runPrefix + std::to_string(runs.size());
+        std::ofstream run(runName.c_str(), std::ios::binary | std::ios::trunc);
+        if (!run)
+        {
+            throw std::runtime_error("cannot create run file " + runName);
+        }
+        runs.add(runName);
+
+        for (uint32_t index: radixSortedOrder(keys))
+        {
+            run.write(reinterpret_cast<const char*>(&records[index]), sizeof(EdgeRecord));
+        }
+        if (!run)
+        {
+            throw std::runtime_error("cannot write run file " + runName);
+        }
+
+        run.close();
+        if (!run)
+        {
+            throw std::runtime_error("cannot close run file " + runName);
+        }
+    }
+}
+
+// Default prefix for the run files of one ExternalKruskal call: the edge
+// file name, the process id and a per-process counter, so concurrent
+// calls on the same edge file never share run files.
+std::string uniqueRunPrefix(const std::string& edgeFile)
+{
+    static std::atomic<unsigned> calls(0);
+    return edgeFile + ".run." + std::to_string(getpid()) + "." + std::to_string(calls++) + ".";
+}
+
+// Kruskal for edge files that do not fit in memory: sorted runs of
+// 'runEdges' edges are written next to 'runPrefix', k-way merged and
+// streamed through UnionFind, which is the only O(V) state. Merging stops
+// as soon as V-1 edges are accepted; the run files are removed afterwards,
+// also when an I/O error or an out-of-range endpoint throws.
+std::vector<Edge> ExternalKruskal(const std::string& edgeFile, uint graphSize,
+                                  size_t runEdges = 1 << 24, const std::string& runPrefix = "")
+{
+    RunFiles runs;
+    writeSortedRuns(edgeFile, runEdges, runPrefix.empty() ? uniqueRunPrefix(edgeFile) : runPrefix, runs);
+
+    const size_t bufferEdges = std::max<size_t>(1, runEdges / (runs.size() + 1));
+    std::vector<std::unique_ptr<EdgeRecordReader>> readers;
+    for (const std::string& run: runs.names())
+    {
+        readers.emplace_back(new EdgeRecordReader(run, bufferEdges));
+    }
+
+    // (key, run) pairs: equal weights come out in run order, which keeps
+    // the merge stable with respect to the input file
+    typedef std::pair<uint32_t, size_t> Head;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    std::vector<EdgeRecord> current(runs.size());
+
+    for (size_t i = 0; i < readers.size(); ++i)
+    {
+        if (readers[i]->next(current[i]))
+        {
+            heads.emplace(radixKey(current[i].weight), i);
+        }
+    }
+
+    std::vector<Edge> result;
+    UnionFind uf(graphSize);
+
+    while (!heads.empty() && result.size() + 1 < graphSize)
+    {
+        size_t run = heads.top().second;
+        heads.pop();
+
+        const EdgeRecord& record = current[run];
+        if (record.from < 0 || uint(record.from) >= graphSize ||
+            record.to < 0 || uint(record.to) >= graphSize)
+        {
+            throw std::runtime_error("edge endpoint out of range in " + edgeFile);
+        }
+        if (!uf.isConnected(record.from, record.to))
+        {
+            uf.connect(record.from, record.to);
+            result.emplace_back(record.from, record.to, record.weight);
+        }
+
+        if (readers[run]->next(current[run]))
+        {
+            heads.emplace(radixKey(current[run].weight), run);
+        }
+    }
+
+    return result;
+}
+
+
 
 #include <cppunit/extensions/TestFactoryRegistry.h>
 #include <cppunit/ui/text/TestRunner.h>
@@ -223,6 +623,8 @@ class Test: public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST( test2 );
     CPPUNIT_TEST( test3 );
     CPPUNIT_TEST( test4 );
+    CPPUNIT_TEST( test5 );
+    CPPUNIT_TEST( test6 );
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -231,6 +633,8 @@ public:
     void test2();
     void test3();
     void test4();
+    void test5();
+    void test6();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( Test );
@@ -282,17 +686,192 @@ void Test::test1()
 
 void Test::test2()
 {
+    std::vector<Edge> vector;
+
+    vector.emplace_back(0, 7, 16);
+    vector.emplace_back(2, 3, 17);
+    vector.emplace_back(1, 7, 19);
+    vector.emplace_back(3, 6, 52);
+    vector.emplace_back(0, 2, 26);
+    vector.emplace_back(5, 7, 28);
+    vector.emplace_back(1, 3, 29);
+    vector.emplace_back(1, 5, 32);
+    vector.emplace_back(2, 7, 34);
+    vector.emplace_back(4, 5, 35);
+    vector.emplace_back(4, 7, 37);
+    vector.emplace_back(1, 2, 36);
+    vector.emplace_back(0, 4, 38);
+    vector.emplace_back(6, 2, 40);
+    vector.emplace_back(6, 4, 93);
 
+    const std::vector<Edge> input = vector;
+
+    std::vector<Edge> result = KruskalByIndex(vector, 8);
+
+    std::vector<Edge> expect;
+    expect.emplace_back(0, 7, 16);
+    expect.emplace_back(2, 3, 17);
+    expect.emplace_back(1, 7, 19);
+    expect.emplace_back(0, 2, 26);
+    expect.emplace_back(5, 7, 28);
+    expect.emplace_back(4, 5, 35);
+    expect.emplace_back(6, 2, 40);
+
+    CPPUNIT_ASSERT_EQUAL(expect, result);
+
+    for (uint i = 0; i < input.size(); ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL(input[i].from(), vector[i].from());
+        CPPUNIT_ASSERT_EQUAL(input[i].to(), vector[i].to());
+    }
 }
 
 void Test::test3()
 {
+    std::vector<Edge> vector;
+
+    vector.emplace_back(0, 1, 3);
+    vector.emplace_back(1, 2, -5);
+    vector.emplace_back(2, 3, 3);
+    vector.emplace_back(0, 3, 3);
+    vector.emplace_back(0, 2, -7);
+
+    std::vector<Edge> result = KruskalByIndex(vector, 4);
 
+    CPPUNIT_ASSERT_EQUAL(size_t(3), result.size());
+
+    // negative weights first, then the first weight-3 edge that joins 3
+    CPPUNIT_ASSERT_EQUAL(-7, result[0].weight());
+    CPPUNIT_ASSERT_EQUAL(-5, result[1].weight());
+    CPPUNIT_ASSERT_EQUAL(2, result[2].from());
+    CPPUNIT_ASSERT_EQUAL(3, result[2].to());
 }
 
 void Test::test4()
 {
+    std::vector<uint32_t> keys(300000);
+    uint32_t seed = 12345;
+    for (uint32_t& key: keys)
+    {
+        seed = seed * 1103515245 + 12345;
+        key = seed;
+    }
+
+    std::vector<uint32_t> expect(keys.size());
+    std::iota(expect.begin(), expect.end(), 0);
+    std::stable_sort(expect.begin(), expect.end(), [&keys](uint32_t left, uint32_t right)
+    {
+        return keys[left] < keys[right];
+    });
+
+    CPPUNIT_ASSERT(expect == radixSortedOrder(keys, 4));
+    CPPUNIT_ASSERT(expect == radixSortedOrder(keys, 1));
+}
+
+void Test::test5()
+{
+    std::vector<EdgeRecord> records = {
+        {0, 7, 16}, {2, 3, 17}, {1, 7, 19}, {3, 6, 52}, {0, 2, 26},
+        {5, 7, 28}, {1, 3, 29}, {1, 5, 32}, {2, 7, 34}, {4, 5, 35},
+        {4, 7, 37}, {1, 2, 36}, {0, 4, 38}, {6, 2, 40}, {6, 4, 93}
+    };
+
+    const std::string fileName = "kruskal_test_edges.bin";
+    {
+        std::ofstream file(fileName.c_str(), std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(EdgeRecord));
+    }
 
+    const std::string runPrefix = "kruskal_test_runs.";
+    std::vector<Edge> result = ExternalKruskal(fileName, 8, 4, runPrefix);
+
+    std::vector<Edge> expect;
+    expect.emplace_back(0, 7, 16);
+    expect.emplace_back(2, 3, 17);
+    expect.emplace_back(1, 7, 19);
+    expect.emplace_back(0, 2, 26);
+    expect.emplace_back(5, 7, 28);
+    expect.emplace_back(4, 5, 35);
+    expect.emplace_back(6, 2, 40);
+
+    CPPUNIT_ASSERT_EQUAL(expect, result);
+
+    for (uint i = 0; i < expect.size(); ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL(expect[i].from(), result[i].from());
+        CPPUNIT_ASSERT_EQUAL(expect[i].to(), result[i].to());
+    }
+
+    std::ifstream run((runPrefix + "0").c_str());
+    CPPUNIT_ASSERT(!run);
+
+    // concurrent calls with the default prefix keep their runs apart
+    std::vector<std::vector<Edge>> results(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < results.size(); ++t)
+    {
+        threads.emplace_back([&, t]() { results[t] = ExternalKruskal(fileName, 8, 2); });
+    }
+    for (std::thread& thread: threads)
+    {
+        thread.join();
+    }
+    for (const std::vector<Edge>& concurrent: results)
+    {
+        CPPUNIT_ASSERT_EQUAL(expect, concurrent);
+    }
+
+    // an endpoint outside the graph throws and still removes the runs
+    {
+        std::ofstream file(fileName.c_str(), std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(EdgeRecord));
+    }
+    CPPUNIT_ASSERT_THROW(ExternalKruskal(fileName, 7, 4, runPrefix), std::runtime_error);
+    CPPUNIT_ASSERT(!std::ifstream((runPrefix + "0").c_str()));
+
+    // a trailing partial record is an error, not the end of the file
+    {
+        std::ofstream file(fileName.c_str(), std::ios::binary | std::ios::app);
+        file.write(reinterpret_cast<const char*>(records.data()), sizeof(int32_t));
+    }
+    CPPUNIT_ASSERT_THROW(ExternalKruskal(fileName, 8, 4, runPrefix), std::runtime_error);
+    CPPUNIT_ASSERT(!std::ifstream((runPrefix + "0").c_str()));
+    std::remove(fileName.c_str());
+}
+
+void Test::test6()
+{
+    std::vector<EdgeRecord> records = {
+        {0, 7, 16}, {2, 3, 17}, {1, 7, 19}, {3, 6, 52}, {0, 2, 26},
+        {5, 7, 28}, {1, 3, 29}, {1, 5, 32}, {2, 7, 34}, {4, 5, 35},
+        {4, 7, 37}, {1, 2, 36}, {0, 4, 38}, {6, 2, 40}, {6, 4, 93}
+    };
+
+    Graph graph(8);
+    for (const EdgeRecord& record: records)
+    {
+        graph.add(record.from, record.to, record.weight);
+    }
+    graph.add(3, 4, 1);
+    graph.deleteEdge(graph.edgeCount() - 1);
+
+    std::vector<Edge> expect;
+    expect.emplace_back(0, 7, 16);
+    expect.emplace_back(2, 3, 17);
+    expect.emplace_back(1, 7, 19);
+    expect.emplace_back(0, 2, 26);
+    expect.emplace_back(5, 7, 28);
+    expect.emplace_back(4, 5, 35);
+    expect.emplace_back(6, 2, 40);
+
+    std::vector<Edge> result = Kruskal(graph);
+    CPPUNIT_ASSERT_EQUAL(expect, result);
+
+    for (uint i = 0; i < expect.size(); ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL(expect[i].from(), result[i].from());
+        CPPUNIT_ASSERT_EQUAL(expect[i].to(), result[i].to());
+    }
 }
 
 int main()
@@ -4,6 +4,10 @@
 #include <limits>
 #include <iostream>
 
+#include "../../common/DaryHeap.h"
+#include "../../common/BucketQueue.h"
+#include "../../common/EdgeArrayGraph.h"
+
 using namespace std;
 
 typedef unsigned int uint;
@@ -43,56 +47,7 @@ private:
 
 };
 
-class Graph
-{
-    public:
-        Graph(size_t size)
-            : m_Edges(size)
-        {}
-
-        void add(const Edge& edge)
-        {
-            m_Edges[edge.from()].push_back(edge);
-            m_Edges[edge.to()].push_back(edge);
-        }
-
-        size_t size() const
-        {
-            return m_Edges.size();
-        }
-
-        const std::vector<Edge>& adjacents(int vertex) const
-        {
-            return m_Edges[vertex];
-        }
-
-        void deleteEdge(const Edge& e)
-        {
-            std::vector<Edge>& v = m_Edges[e.from()];
-            for (std::vector<Edge>::iterator it = v.begin(); it != v.end(); ++it)
-            {
-               if (it->to() == e.to())
-               {
-                   v.erase(it);
-                   break;
-               } 
-            }
-
-
-            std::vector<Edge>& v1 = m_Edges[e.to()];
-            for (std::vector<Edge>::iterator it = v1.begin(); it != v1.end(); ++it)
-            {
-               if (it->from() == e.from())
-               {
-                   v1.erase(it);
-                   break;
-               } 
-            }
-        }
-
-    private:
-        std::vector<std::vector<Edge>> m_Edges;
-};
+typedef EdgeArrayGraph Graph;
 
 
 bool operator==(const Edge& left, const Edge& right)
@@ -106,192 +61,175 @@ bool operator<(const Edge& left, const Edge& right)
 }
 
 
-class Heap
+// the heap holds 4-byte edge ids ordered by the weights stored in the graph
+struct EdgeIdLess
 {
+    const Graph* graph;
 
-private:
-    std::vector<Edge> m_Edges;
-
-private:
-
-    int leftIndex(int position)
+    bool operator()(uint32_t left, uint32_t right) const
     {
-        return position * 2 + 1;
+        return graph->weight(left) < graph->weight(right);
     }
+};
 
-    int rightIndex(int position)
-    {
-        return position * 2 + 2;
-    }
+struct EdgeIdWeight
+{
+    const Graph* graph;
 
-    int parentIndex(int position)
+    unsigned operator()(uint32_t id) const
     {
-        return (position-1)/2;
+        return graph->weight(id);
     }
+};
 
-//-----------------------------------------------
-    Edge& left(int position)
-    {
-        return m_Edges[leftIndex(position)];
-    }
+typedef DaryHeap<uint32_t, 4, EdgeIdLess> Heap;
 
-    Edge& right(int position)
-    {
-        return m_Edges[rightIndex(position)];
-    }
+// for small non-negative integer weights: LazyPrim(graph, bucketQueue)
+typedef BucketQueue<uint32_t, EdgeIdWeight> EdgeBucketQueue;
 
-    Edge& parent(int position)
-    {
-        return m_Edges[parentIndex(position)];
-    }
+std::ostream& operator<<(std::ostream& os, const Edge& v)
+{
+    os << v.from() << " -> " << v.to() << " weight: " << v.weight();
+    return os;
+}
 
-    bool m_Comparator(const Edge& e1, const Edge& e2)
+// Queue is any priority queue of edge ids with push/pop/top/empty, e.g.
+// Heap or EdgeBucketQueue built over the same graph
+template <class Queue>
+std::vector<Edge> LazyPrim(const Graph& graph, Queue& heap)
+{
+    std::vector<Edge> result;
+    if (graph.size() == 0)
     {
-        return e1 < e2;
+        return result;
     }
-//---------------------------------------------
 
-    int size() const
-    {
-        return m_Edges.size();
-    }
+    int vertex = 0;
+    std::vector<bool> attached(graph.size(), false);
+    attached[vertex] = true;
+    int counter = graph.size()-1;
 
-    int sinkOnce(int position)
+    while (counter)
     {
-        int currentPosition = position;
-        if (leftIndex(position) < size())
-        {
-            if (m_Comparator(left(position), m_Edges[position]))
-            {
-                std::swap(left(position), m_Edges[position]);
-                currentPosition = leftIndex(position);
-            }
-        }
-
-        if (rightIndex(position) < size())
+        for (uint32_t id: graph.adjacents(vertex))
         {
-            if (m_Comparator(right(position), m_Edges[position]))
+            if (attached[graph.other(id, vertex)] == false)
             {
-                std::swap(right(position), m_Edges[position]);
-
-                if (position == currentPosition) // an element wasn't swapped
-                {
-                    currentPosition = rightIndex(position);
-                }
+                heap.push(id);
             }
-        }
 
-        return currentPosition;
-    }
-
-    int promoteOnce(int position)
-    {
-        if (m_Comparator(m_Edges[position], parent(position)))
-        {
-            std::swap(m_Edges[position], parent(position));
-            return parentIndex(position);
         }
-        return position;
-    }
-
 
-    int sink(int position)
-    {
-        int nextPosition;
-        while (position != (nextPosition = sinkOnce(position)))
+        // skip edges whose both ends got attached since they were pushed;
+        // an empty heap means the rest of the graph is not reachable
+        while (!heap.empty() && attached[graph.to(heap.top())] && attached[graph.from(heap.top())])
         {
-            position = nextPosition;
+            heap.pop();
         }
-
-        return position;
-    }
-
-    int promote(int position)
-    {
-        int nextPosition;
-        while (position != (nextPosition = promoteOnce(position)))
+        if (heap.empty())
         {
-            position = nextPosition;
+            break;
         }
 
-        return position;
-    }
-
-
-//
-public:
-    Heap()
-        : m_Edges()
-    {}
-
-    bool empty() const
-    {
-        return size() == 0;
-    }
-
-    void add(const Edge& edge)
-    {
-        int pos = m_Edges.size();
-
-        m_Edges.push_back(edge);
-
-        promote(pos);
-    }
-
-    Edge pop()
-    {
-        Edge e = m_Edges[0];
-
-        m_Edges[0] = m_Edges.back();
-        m_Edges.pop_back();
-
-        sink(0);
-
-        return e;
+        uint32_t id = heap.pop();
+        --counter;
+        result.emplace_back(graph.from(id), graph.to(id), graph.weight(id));
+        vertex = attached[graph.to(id)] ? graph.from(id) : graph.to(id);
+        attached[vertex] = true;
     }
 
+    return result;
+}
 
+std::vector<Edge> LazyPrim(const Graph& graph)
+{
+    Heap heap(0, EdgeIdLess{&graph});
+    return LazyPrim(graph, heap);
+}
 
+struct LazyPrimStats
+{
+    size_t peakHeapSize;
+    size_t compactions;
+    size_t skippedPushes;
 };
 
-std::ostream& operator<<(std::ostream& os, const Edge& v)
+// LazyPrim that keeps its heap small. An edge is not pushed when an edge
+// at least as light to the same unattached vertex is already queued, and
+// once the stale entries (both ends attached) exceed 'staleRatio' of the
+// heap they are filtered out in bulk and the heap is rebuilt in O(n).
+std::vector<Edge> LazyPrim(const Graph& graph, LazyPrimStats& stats, double staleRatio = 0.5)
 {
-    os << v.from() << " -> " << v.to() << " weight: " << v.weight();
-    return os;
-}
+    stats = LazyPrimStats{0, 0, 0};
 
-std::vector<Edge> LazyPrim(const Graph& graph)
-{
     std::vector<Edge> result;
+    if (graph.size() == 0)
+    {
+        return result;
+    }
 
-    Heap heap;
+    Heap heap(0, EdgeIdLess{&graph});
+
+    // lightest queued edge to every unattached vertex, and how many queued
+    // edges lead to it: they all turn stale once it is attached
+    std::vector<int> bestTo(graph.size(), std::numeric_limits<int>::max());
+    std::vector<size_t> pending(graph.size(), 0);
+    size_t stale = 0;
 
     int vertex = 0;
     std::vector<bool> attached(graph.size(), false);
     attached[vertex] = true;
     int counter = graph.size()-1;
 
-    do
+    while (counter)
     {
-        const std::vector<Edge>& edges = graph.adjacents(vertex);
-
-        for (const Edge& e: edges)
+        for (uint32_t id: graph.adjacents(vertex))
         {
-            if (attached[e.other(vertex)] == false)
+            int next = graph.other(id, vertex);
+            if (attached[next])
             {
-                heap.add(e);
+                continue;
             }
 
+            if (graph.weight(id) >= bestTo[next])
+            {
+                ++stats.skippedPushes;
+                continue;
+            }
+
+            bestTo[next] = graph.weight(id);
+            ++pending[next];
+            heap.push(id);
+        }
+        stats.peakHeapSize = std::max(stats.peakHeapSize, heap.size());
+
+        while (!heap.empty() && attached[graph.to(heap.top())] && attached[graph.from(heap.top())])
+        {
+            heap.pop();
+            --stale;
+        }
+        if (heap.empty())
+        {
+            break;
         }
 
-        Edge e = heap.pop();
-        if (attached[e.to()] && attached[e.from()]) continue;
+        uint32_t id = heap.pop();
         --counter;
-        result.push_back(e);
-        vertex = attached[e.to()] ? e.from(): e.to() ;
+        result.emplace_back(graph.from(id), graph.to(id), graph.weight(id));
+        vertex = attached[graph.to(id)] ? graph.from(id) : graph.to(id);
         attached[vertex] = true;
+        stale += pending[vertex] - 1;
 
-    } while (counter);
+        if (stale > 64 && stale > staleRatio * heap.size())
+        {
+            heap.removeIf([&graph, &attached](uint32_t queued)
+            {
+                return attached[graph.from(queued)] && attached[graph.to(queued)];
+            });
+            stale = 0;
+            ++stats.compactions;
+        }
+    }
 
     return result;
 }
@@ -328,6 +266,7 @@ class Test: public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST( test2 );
     CPPUNIT_TEST( test3 );
     CPPUNIT_TEST( test4 );
+    CPPUNIT_TEST( test5 );
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -336,6 +275,7 @@ public:
     void test2();
     void test3();
     void test4();
+    void test5();
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( Test );
@@ -402,17 +342,140 @@ void Test::test1()
 
 void Test::test2()
 {
+    std::vector<int> values;
+    uint32_t seed = 11;
+    for (int i = 0; i < 1000; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        values.push_back((seed >> 8) % 300);
+    }
+
+    DaryHeap<int, 2> binary;
+    DaryHeap<int, 8, std::greater<int>> octal;
+    for (int value: values)
+    {
+        binary.push(value);
+        octal.push(value);
+    }
 
+    std::vector<int> ascending = values;
+    std::sort(ascending.begin(), ascending.end());
+
+    for (uint i = 0; i < values.size(); ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL(ascending[i], binary.pop());
+        CPPUNIT_ASSERT_EQUAL(ascending[values.size() - 1 - i], octal.pop());
+    }
+    CPPUNIT_ASSERT(binary.empty());
+    CPPUNIT_ASSERT(octal.empty());
 }
 
 void Test::test3()
 {
+    std::vector<Edge> vector;
+
+    vector.emplace_back(0, 2, 26);
+    vector.emplace_back(0, 4, 38);
+    vector.emplace_back(0, 7, 16);
+    vector.emplace_back(1, 7, 19);
+    vector.emplace_back(1, 3, 29);
+    vector.emplace_back(1, 5, 32);
+    vector.emplace_back(1, 2, 36);
+    vector.emplace_back(2, 3, 17);
+    vector.emplace_back(2, 7, 34);
+    vector.emplace_back(3, 6, 52);
+    vector.emplace_back(4, 5, 35);
+    vector.emplace_back(4, 7, 37);
+    vector.emplace_back(5, 7, 28);
+    vector.emplace_back(6, 2, 40);
+    vector.emplace_back(6, 4, 93);
+
+    Graph graph(8);
+    for (const Edge& e: vector)
+    {
+        graph.add(e);
+    }
+
+    EdgeBucketQueue queue(100, 0, EdgeIdWeight{&graph});
+    std::vector<Edge> result = LazyPrim(graph, queue);
+    std::vector<Edge> expect = LazyPrim(graph);
 
+    std::sort(result.begin(), result.end());
+    std::sort(expect.begin(), expect.end());
+
+    CPPUNIT_ASSERT_EQUAL(expect, result);
 }
 
 void Test::test4()
 {
+    // vertices 3 and 4 cannot be reached from 0
+    Graph graph(5);
+    graph.add(Edge(0, 1, 4));
+    graph.add(Edge(1, 2, 2));
+    graph.add(Edge(0, 2, 9));
+    graph.add(Edge(3, 4, 1));
+
+    std::vector<Edge> result = LazyPrim(graph);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(2), result.size());
+    CPPUNIT_ASSERT_EQUAL(2, result[1].weight());
+}
+
+void Test::test5()
+{
+    // a few hubs linked to everything, the rest sparsely linked
+    const uint size = 3000;
+    Graph graph(size);
+
+    uint32_t seed = 17;
+    auto random = [&seed]()
+    {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) & 0xffff;
+    };
+
+    for (uint v = 1; v < size; ++v)
+    {
+        graph.add(Edge(v, random() % v, random() % 5000));
+        for (int hub = 0; hub < 8; ++hub)
+        {
+            graph.add(Edge(v, hub, random() % 5000));
+        }
+    }
 
+    LazyPrimStats stats;
+    std::vector<Edge> result = LazyPrim(graph, stats);
+    std::vector<Edge> expect = LazyPrim(graph);
+
+    CPPUNIT_ASSERT_EQUAL(expect.size(), result.size());
+
+    long long total = 0, expectTotal = 0;
+    for (uint i = 0; i < result.size(); ++i)
+    {
+        total += result[i].weight();
+        expectTotal += expect[i].weight();
+    }
+    CPPUNIT_ASSERT_EQUAL(expectTotal, total);
+
+    CPPUNIT_ASSERT(stats.skippedPushes > 0);
+    CPPUNIT_ASSERT(stats.compactions > 0);
+    CPPUNIT_ASSERT(stats.peakHeapSize < graph.edgeCount() / 2);
+
+    DaryHeap<int, 4> heap;
+    for (int i = 0; i < 100; ++i)
+    {
+        heap.push((i * 37) % 100);
+    }
+    heap.removeIf([](int value) { return value % 3 == 0; });
+
+    CPPUNIT_ASSERT_EQUAL(size_t(66), heap.size());
+    int previous = -1;
+    while (!heap.empty())
+    {
+        int value = heap.pop();
+        CPPUNIT_ASSERT(value > previous && value % 3 != 0);
+        previous = value;
+    }
 }
 
 int main()
@@ -0,0 +1,677 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <assert.h>
+#include <cstdint>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../../common/DijkstraContext.h"
+
+using namespace std;
+
+typedef unsigned int uint;
+
+class Edge
+{
+    int m_from, m_to;
+    float m_weight;
+public:
+    Edge(int from, int to, float weight)
+        : m_from(from), m_to(to), m_weight(weight)
+    { }
+
+    Edge(char from, char to, float weight)
+        : m_from(from - 'A'), m_to(to - 'A'), m_weight(weight)
+    { }
+
+    int from() const { return m_from; }
+    int to() const { return m_to; }
+    float weight() const { return m_weight; }
+};
+
+
+class Graph
+{
+    std::vector< std::vector<Edge> > m_edges;
+public:
+    Graph(int size)
+        : m_edges(size)
+    { }
+
+    size_t size() const { return m_edges.size(); }
+
+    void add(const Edge& e) { m_edges[e.from()].push_back(e); }
+    void add(int from, int to, float weight)
+    { 
+        Edge e(from, to, weight);
+        add(e);
+    }
+
+    void add(char from, char to, float weight)
+    { 
+        Edge e(from, to, weight);
+        add(e);
+    }
+
+    const std::vector<Edge>& connected(int vertex) const 
+    {
+        return m_edges[vertex];
+    }
+};
+
+struct Result
+{
+    int from;
+    int path;
+};
+
+
+// Distances to and from K landmarks, stored [vertex][landmark] so that one
+// lower bound reads two adjacent rows. Unreachable entries are UNREACHED.
+// The tables either own their arrays (build) or map a file saved earlier
+// (load); the file is the header followed by the arrays as they are in
+// memory, so loading costs one mmap.
+class LandmarkTables
+{
+public:
+    static const uint32_t UNREACHED = 0xffffffff;
+
+    LandmarkTables() {}
+    LandmarkTables(const LandmarkTables&) = delete;
+    LandmarkTables& operator=(const LandmarkTables&) = delete;
+
+    ~LandmarkTables()
+    {
+        unmap();
+    }
+
+    // Picks 'count' landmarks by farthest-point selection, preferring
+    // vertices that no landmark reaches yet, and runs one Dijkstra per
+    // landmark on the graph and one on its reverse. Weights must not be
+    // negative.
+    void build(const Graph& graph, uint count);
+
+    // Both throw std::runtime_error on I/O errors or a foreign file.
+    void save(const std::string& fileName) const;
+    void load(const std::string& fileName);
+
+    size_t size() const { return m_Size; }
+    uint landmarkCount() const { return m_Count; }
+    int landmark(uint index) const { return m_Landmarks[index]; }
+
+    // distance from landmark 'index' to 'vertex' and back
+    uint32_t from(uint index, int vertex) const { return m_From[vertex * m_Count + index]; }
+    uint32_t to(uint index, int vertex) const { return m_To[vertex * m_Count + index]; }
+
+    // triangle inequality lower bound on the distance from 'vertex' to 'target'
+    int lowerBound(int vertex, int target) const
+    {
+        const uint32_t* fromVertex = m_From + vertex * m_Count;
+        const uint32_t* fromTarget = m_From + target * m_Count;
+        const uint32_t* toVertex = m_To + vertex * m_Count;
+        const uint32_t* toTarget = m_To + target * m_Count;
+
+        int64_t bound = 0;
+        for (uint i = 0; i < m_Count; ++i)
+        {
+            if (fromVertex[i] != UNREACHED && fromTarget[i] != UNREACHED)
+            {
+                bound = std::max<int64_t>(bound, int64_t(fromTarget[i]) - fromVertex[i]);
+            }
+            if (toVertex[i] != UNREACHED && toTarget[i] != UNREACHED)
+            {
+                bound = std::max<int64_t>(bound, int64_t(toVertex[i]) - toTarget[i]);
+            }
+        }
+        return bound;
+    }
+
+private:
+    static const uint32_t MAGIC = 0x544c4131; // "1ALT"
+
+    void unmap()
+    {
+        if (m_Mapped)
+        {
+            munmap(m_Mapped, m_MappedBytes);
+            m_Mapped = nullptr;
+        }
+    }
+
+    void point(const uint32_t* landmarks, const uint32_t* from, const uint32_t* to)
+    {
+        m_Landmarks = landmarks;
+        m_From = from;
+        m_To = to;
+    }
+
+    size_t m_Size = 0;
+    uint m_Count = 0;
+    const uint32_t* m_Landmarks = nullptr;
+    const uint32_t* m_From = nullptr;
+    const uint32_t* m_To = nullptr;
+
+    std::vector<uint32_t> m_Owned;
+    void* m_Mapped = nullptr;
+    size_t m_MappedBytes = 0;
+};
+
+const uint32_t LandmarkTables::UNREACHED;
+const uint32_t LandmarkTables::MAGIC;
+
+void LandmarkTables::build(const Graph& graph, uint count)
+{
+    const int size = graph.size();
+    count = std::min<uint>(count, size);
+
+    Graph reverse(size);
+    for (int vertex = 0; vertex < size; ++vertex)
+    {
+        for (const Edge& edge: graph.connected(vertex))
+        {
+            reverse.add(edge.to(), vertex, edge.weight());
+        }
+    }
+
+    unmap();
+    m_Owned.assign(count + 2 * size_t(size) * count, UNREACHED);
+    m_Size = size;
+    m_Count = count;
+    uint32_t* landmarks = m_Owned.data();
+    uint32_t* from = landmarks + count;
+    uint32_t* to = from + size_t(size) * count;
+    point(landmarks, from, to);
+
+    // distance to the nearest landmark so far, UNREACHED if none reaches
+    std::vector<uint32_t> nearest(size, UNREACHED);
+    DijkstraContext<Result> forward(size);
+    DijkstraContext<Result> backward(size);
+
+    // the search from vertex 0 only seeds the first pick
+    const std::vector<Result>& seed = Dijkstra(graph, 0, forward);
+    int next = 0;
+    for (int vertex = 0; vertex < size; ++vertex)
+    {
+        if (seed[vertex].from != -1 && seed[vertex].path > seed[next].path)
+        {
+            next = vertex;
+        }
+    }
+
+    for (uint index = 0; index < count; ++index)
+    {
+        landmarks[index] = next;
+
+        const std::vector<Result>& down = Dijkstra(graph, next, forward);
+        const std::vector<Result>& up = Dijkstra(reverse, next, backward);
+        for (int vertex = 0; vertex < size; ++vertex)
+        {
+            if (down[vertex].from != -1)
+            {
+                from[vertex * count + index] = down[vertex].path;
+                nearest[vertex] = std::min<uint32_t>(nearest[vertex], down[vertex].path);
+            }
+            if (up[vertex].from != -1)
+            {
+                to[vertex * count + index] = up[vertex].path;
+            }
+        }
+
+        // farthest from all landmarks; UNREACHED sorts last, so vertices
+        // in a part no landmark reaches come first
+        for (int vertex = 0; vertex < size; ++vertex)
+        {
+            if (nearest[vertex] > nearest[next])
+            {
+                next = vertex;
+            }
+        }
+    }
+}
+
+void LandmarkTables::save(const std::string& fileName) const
+{
+    FILE* file = std::fopen(fileName.c_str(), "wb");
+    if (!file)
+    {
+        throw std::runtime_error("cannot create landmark file " + fileName);
+    }
+
+    const size_t entries = m_Size * m_Count;
+    uint32_t header[4] = {MAGIC, 0, uint32_t(m_Size), m_Count};
+    bool written = std::fwrite(header, sizeof(header), 1, file) == 1
+                && std::fwrite(m_Landmarks, sizeof(uint32_t), m_Count, file) == m_Count
+                && std::fwrite(m_From, sizeof(uint32_t), entries, file) == entries
+                && std::fwrite(m_To, sizeof(uint32_t), entries, file) == entries;
+
+    if (std::fclose(file) != 0 || !written)
+    {
+        throw std::runtime_error("cannot write landmark file " + fileName);
+    }
+}
+
+void LandmarkTables::load(const std::string& fileName)
+{
+    int descriptor = open(fileName.c_str(), O_RDONLY);
+    if (descriptor < 0)
+    {
+        throw std::runtime_error("cannot open landmark file " + fileName);
+    }
+
+    struct stat status;
+    void* mapped = MAP_FAILED;
+    if (fstat(descriptor, &status) == 0 && status.st_size >= off_t(4 * sizeof(uint32_t)))
+    {
+        mapped = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    }
+    close(descriptor);
+
+    if (mapped == MAP_FAILED)
+    {
+        throw std::runtime_error("cannot map landmark file " + fileName);
+    }
+
+    const uint32_t* header = static_cast<const uint32_t*>(mapped);
+    const size_t size = header[2];
+    const uint count = header[3];
+    if (header[0] != MAGIC || size_t(status.st_size) != (4 + count + 2 * size * count) * sizeof(uint32_t))
+    {
+        munmap(mapped, status.st_size);
+        throw std::runtime_error("not a landmark file: " + fileName);
+    }
+
+    unmap();
+    m_Owned.clear();
+    m_Mapped = mapped;
+    m_MappedBytes = status.st_size;
+    m_Size = size;
+    m_Count = count;
+    point(header + 4, header + 4 + count, header + 4 + count + size * count);
+}
+
+// A* point-to-point queries guided by LandmarkTables::lowerBound. The
+// bound is consistent, so every vertex is settled at most once and the
+// search stops when the target is. One query object per thread; like
+// DijkstraContext it only resets what the previous query touched.
+class AltQuery
+{
+public:
+    AltQuery(const Graph& graph, const LandmarkTables& tables)
+        : m_Graph(graph)
+        , m_Tables(tables)
+        , m_Result(graph.size(), {-1, 999999})
+        , m_Done(graph.size(), false)
+        , m_Touched()
+        , m_Heap(graph.size())
+        , m_Settled(0)
+    {
+        assert(tables.size() == graph.size());
+    }
+
+    // shortest path length, 999999 when 'target' cannot be reached
+    int distance(int source, int target)
+    {
+        search(source, target);
+        return m_Result[target].path;
+    }
+
+    // vertices of a shortest path, both ends included; empty when
+    // 'target' cannot be reached
+    std::vector<int> path(int source, int target)
+    {
+        std::vector<int> path;
+        search(source, target);
+        if (m_Result[target].from == -1)
+        {
+            return path;
+        }
+
+        for (int vertex = target; vertex != source; vertex = m_Result[vertex].from)
+        {
+            path.push_back(vertex);
+        }
+        path.push_back(source);
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    // vertices settled by the last query
+    size_t settled() const
+    {
+        return m_Settled;
+    }
+
+private:
+    void search(int source, int target)
+    {
+        for (int vertex: m_Touched)
+        {
+            m_Result[vertex] = {-1, 999999};
+            m_Done[vertex] = false;
+        }
+        m_Touched.clear();
+        m_Heap.clear();
+        m_Settled = 0;
+
+        m_Result[source] = {source, 0};
+        m_Touched.push_back(source);
+        m_Heap.push({source, m_Tables.lowerBound(source, target)});
+
+        while (!m_Heap.empty())
+        {
+            int vertex = m_Heap.pop().vertex;
+            m_Done[vertex] = true;
+            ++m_Settled;
+
+            if (vertex == target)
+            {
+                break;
+            }
+
+            for (const Edge& edge: m_Graph.connected(vertex))
+            {
+                int next = edge.to();
+                if (!m_Done[next] && m_Result[vertex].path + edge.weight() < m_Result[next].path)
+                {
+                    if (m_Result[next].from == -1)
+                    {
+                        m_Touched.push_back(next);
+                    }
+                    m_Result[next].path = m_Result[vertex].path + edge.weight();
+                    m_Result[next].from = vertex;
+                    m_Heap.pushOrDecrease({next, m_Result[next].path + m_Tables.lowerBound(next, target)});
+                }
+            }
+        }
+    }
+
+    const Graph& m_Graph;
+    const LandmarkTables& m_Tables;
+    std::vector<Result> m_Result;
+    std::vector<bool> m_Done;
+    std::vector<int> m_Touched;
+    VertexHeap m_Heap;
+    size_t m_Settled;
+};
+
+
+std::ostream& operator<<(std::ostream& os, const std::vector<int>& v)
+{
+    os << '[';
+
+    if (!v.empty())
+    {
+        os << v[0];
+
+        for (auto it = v.begin()+1; it != v.end(); ++it)
+        {
+            os << ", " << *it;
+        }
+    }
+    os << ']';
+    return os;
+}
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test: public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE( Test ); 
+
+    CPPUNIT_TEST( test1 );
+    CPPUNIT_TEST( test2 );
+    CPPUNIT_TEST( test3 );
+    CPPUNIT_TEST( test4 );
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void test1();
+    void test2();
+    void test3();
+    void test4();
+};
+CPPUNIT_TEST_SUITE_REGISTRATION( Test );
+
+// Road-like test graph: 'size' towns at random points of a 100 x 100
+// square, each joined to its next three towns by x coordinate. A road
+// costs its Manhattan length plus one, uphill (toward larger y) two more,
+// so distances follow the geometry the landmarks exploit but are not
+// symmetric.
+Graph townGraph(int size, uint seed)
+{
+    std::vector<std::pair<int, int>> towns(size);
+    for (auto& town: towns)
+    {
+        seed = seed * 1103515245 + 12345;
+        town = {(seed >> 8) % 100, (seed >> 20) % 100};
+    }
+    std::sort(towns.begin(), towns.end());
+
+    Graph graph(size);
+    for (int town = 0; town < size; ++town)
+    {
+        for (int next = town + 1; next < std::min(size, town + 4); ++next)
+        {
+            int length = 1 + std::abs(towns[next].first - towns[town].first)
+                           + std::abs(towns[next].second - towns[town].second);
+            bool uphill = towns[next].second > towns[town].second;
+            graph.add(town, next, length + (uphill ? 2 : 0));
+            graph.add(next, town, length + (uphill ? 0 : 2));
+        }
+    }
+
+    return graph;
+}
+
+// Checks the tables and queries target by target, the way A* uses them:
+// one Dijkstra on the reverse graph gives every exact distance to the
+// target. The bound toward it must not exceed them, must drop by at most
+// an edge's weight across it (consistency, so each vertex is settled
+// once), and every query must find the exact distance along real edges.
+void checkLandmarks(const Graph& graph, const LandmarkTables& tables)
+{
+    Graph reverse(graph.size());
+    for (size_t vertex = 0; vertex < graph.size(); ++vertex)
+    {
+        for (const Edge& edge: graph.connected(vertex))
+        {
+            reverse.add(edge.to(), vertex, edge.weight());
+        }
+    }
+
+    AltQuery query(graph, tables);
+    DijkstraContext<Result> context(graph.size());
+
+    for (size_t target = 0; target < graph.size(); ++target)
+    {
+        const std::vector<Result>& toTarget = Dijkstra(reverse, target, context);
+
+        for (size_t vertex = 0; vertex < graph.size(); ++vertex)
+        {
+            std::vector<int> path = query.path(vertex, target);
+            if (toTarget[vertex].from == -1)
+            {
+                CPPUNIT_ASSERT(path.empty());
+                CPPUNIT_ASSERT_EQUAL(999999, query.distance(vertex, target));
+                continue;
+            }
+
+            const int bound = tables.lowerBound(vertex, target);
+            CPPUNIT_ASSERT(bound <= toTarget[vertex].path);
+            for (const Edge& edge: graph.connected(vertex))
+            {
+                CPPUNIT_ASSERT(bound <= edge.weight() + tables.lowerBound(edge.to(), target));
+            }
+
+            CPPUNIT_ASSERT_EQUAL(toTarget[vertex].path, query.distance(vertex, target));
+            CPPUNIT_ASSERT_EQUAL(int(vertex), path.front());
+            CPPUNIT_ASSERT_EQUAL(int(target), path.back());
+
+            // each hop is an edge whose weight closes the gap to the target
+            for (size_t i = 1; i < path.size(); ++i)
+            {
+                bool tight = false;
+                for (const Edge& edge: graph.connected(path[i - 1]))
+                {
+                    tight |= edge.to() == path[i] &&
+                             edge.weight() + toTarget[path[i]].path == toTarget[path[i - 1]].path;
+                }
+                CPPUNIT_ASSERT(tight);
+            }
+        }
+    }
+}
+
+void Test::test1()
+{
+    Graph graph(8);
+
+    graph.add(0, 1, 5);
+    graph.add(0, 4, 9);
+    graph.add(0, 7, 8);
+
+    graph.add(1, 2, 12);
+    graph.add(1, 3, 15);
+    graph.add(1, 7, 4);
+
+    graph.add(2, 3, 3);
+    graph.add(2, 6, 11);
+
+    graph.add(3, 6, 9);
+
+    graph.add(4, 5, 4);
+    graph.add(4, 6, 20);
+    graph.add(4, 7, 5);
+
+    graph.add(5, 2, 1);
+    graph.add(5, 6, 13);
+
+    graph.add(7, 2, 7);
+    graph.add(7, 5, 6);
+
+    LandmarkTables tables;
+    tables.build(graph, 2);
+
+    // 6 is farthest from 0, then 0 is farthest from 6 (which reaches nothing)
+    CPPUNIT_ASSERT_EQUAL(6, tables.landmark(0));
+    CPPUNIT_ASSERT_EQUAL(0, tables.landmark(1));
+    CPPUNIT_ASSERT_EQUAL(uint32_t(25), tables.to(0, 0));
+    CPPUNIT_ASSERT_EQUAL(LandmarkTables::UNREACHED, tables.from(0, 0));
+
+    AltQuery query(graph, tables);
+    std::vector<int> path = {0, 4, 5, 2, 6};
+    CPPUNIT_ASSERT_EQUAL(path, query.path(0, 6));
+
+    checkLandmarks(graph, tables);
+}
+
+void Test::test2()
+{
+    Graph graph = townGraph(250, 3);
+
+    LandmarkTables tables;
+    tables.build(graph, 4);
+    checkLandmarks(graph, tables);
+
+    AltQuery query(graph, tables);
+    DijkstraContext<Result> context(graph.size());
+    const int landmark = tables.landmark(0);
+
+    size_t altSettled = 0;
+    size_t dijkstraSettled = 0;
+    for (size_t source = 0; source < graph.size(); ++source)
+    {
+        std::vector<Result> distance = Dijkstra(graph, source, context);
+
+        // the bound is exact toward a landmark: A* only settles vertices
+        // on shortest paths there
+        query.distance(source, landmark);
+        size_t onPath = 0;
+        for (size_t vertex = 0; vertex < graph.size(); ++vertex)
+        {
+            onPath += distance[vertex].path + int(tables.to(0, vertex)) == distance[landmark].path;
+        }
+        CPPUNIT_ASSERT(query.settled() <= onPath);
+
+        // Dijkstra settles at least every vertex closer than the target
+        for (size_t target = 0; target < graph.size(); ++target)
+        {
+            query.distance(source, target);
+            altSettled += query.settled();
+            for (size_t vertex = 0; vertex < graph.size(); ++vertex)
+            {
+                dijkstraSettled += distance[vertex].path < distance[target].path;
+            }
+        }
+    }
+    CPPUNIT_ASSERT(2 * altSettled < dijkstraSettled);
+}
+
+void Test::test3()
+{
+    // A, B, C and D, E: landmarks land in both parts
+    Graph graph(5);
+
+    graph.add('A', 'B', 2);
+    graph.add('B', 'C', 2);
+    graph.add('C', 'A', 2);
+    graph.add('D', 'E', 1);
+    graph.add('E', 'D', 1);
+
+    LandmarkTables tables;
+    tables.build(graph, 2);
+
+    CPPUNIT_ASSERT(tables.landmark(0) < 3);
+    CPPUNIT_ASSERT(tables.landmark(1) >= 3);
+    checkLandmarks(graph, tables);
+}
+
+void Test::test4()
+{
+    Graph graph = townGraph(120, 5);
+
+    LandmarkTables built;
+    built.build(graph, 3);
+
+    const std::string fileName = "alt_test_landmarks.bin";
+    built.save(fileName);
+
+    LandmarkTables loaded;
+    loaded.load(fileName);
+    std::remove(fileName.c_str());
+
+    CPPUNIT_ASSERT_EQUAL(built.size(), loaded.size());
+    CPPUNIT_ASSERT_EQUAL(built.landmarkCount(), loaded.landmarkCount());
+    for (size_t vertex = 0; vertex < graph.size(); ++vertex)
+    {
+        for (uint i = 0; i < built.landmarkCount(); ++i)
+        {
+            CPPUNIT_ASSERT_EQUAL(built.from(i, vertex), loaded.from(i, vertex));
+            CPPUNIT_ASSERT_EQUAL(built.to(i, vertex), loaded.to(i, vertex));
+        }
+    }
+    checkLandmarks(graph, loaded);
+
+    CPPUNIT_ASSERT_THROW(loaded.load("alt_test_missing.bin"), std::runtime_error);
+}
+
+int main()
+{
+    CppUnit::TextUi::TestRunner runner;
+    CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+    runner.addTest( registry.makeTest() );
+    runner.run();
+    return 0;
+}
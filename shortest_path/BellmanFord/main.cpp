@@ -4,6 +4,14 @@
 #include <limits>
 #include <iostream>
 #include <assert.h>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+#include <memory>
 
 using namespace std;
 
@@ -31,14 +39,18 @@ public:
 class Graph
 {
     std::vector< std::vector<Edge> > m_edges;
+    uint64_t m_version;
 public:
     Graph(int size)
-        : m_edges(size)
+        : m_edges(size), m_version(0)
     { }
 
     size_t size() const { return m_edges.size(); }
 
-    void add(const Edge& e) { m_edges[e.from()].push_back(e); }
+    // bumped by every change, so results computed earlier can be told stale
+    uint64_t version() const { return m_version; }
+
+    void add(const Edge& e) { m_edges[e.from()].push_back(e); ++m_version; }
     void add(int from, int to, float weight)
     { 
         Edge e(from, to, weight);
@@ -63,19 +75,55 @@ struct Result
     int path;
 };
 
-void relax(const Graph& graph, int vertex, std::vector<Result>& results, std::vector<bool>& relaxed)
+// Walks the parent ('from') pointers up from 'vertex'. When 'target' is met,
+// 'vertex' lies in the subtree of 'target' and the edge vertex -> target
+// closes a cycle: it is stored in 'cycle' in edge order, starting at target.
+bool closesCycle(const std::vector<Result>& results, int vertex, int target, std::vector<int>& cycle)
+{
+    std::vector<int> path;
+    for (int v = vertex; ; v = results[v].from)
+    {
+        path.push_back(v);
+        if (v == target)
+        {
+            cycle.assign(path.rbegin(), path.rend());
+            return true;
+        }
+        if (results[v].from == v || results[v].from == -1)
+        {
+            return false;
+        }
+    }
+}
+
+// Relaxes the out-edges of 'vertex'. With 'cycle' set, every improvement
+// is first checked against the parent tree; returns true once a negative
+// cycle was found.
+bool relax(const Graph& graph, int vertex, std::vector<Result>& results,
+           std::deque<int>& verticeToUpdate, std::vector<bool>& queued, std::vector<int>* cycle)
 {
     for (const Edge& edge: graph.connected(vertex))
     {
         int next = edge.to();
         if (results[vertex].path + edge.weight() < results[next].path)
         {
+            if (cycle && closesCycle(results, vertex, next, *cycle))
+            {
+                return true;
+            }
+
             results[next].path = results[vertex].path + edge.weight();
             results[next].from = vertex;
-            relaxed[next] = true;
-            
+
+            if (!queued[next])
+            {
+                queued[next] = true;
+                verticeToUpdate.push_back(next);
+            }
         }
     }
+
+    return false;
 }
 
 
@@ -96,40 +144,392 @@ std::ostream& operator<<(std::ostream& os, const std::vector<int>& v)
     return os;
 }
 
-std::vector<Result> BellmanFord(const Graph& graph, int source)
+// Queue-based Bellman-Ford (SPFA): only vertices whose distance changed
+// are relaxed again, and the search ends as soon as the worklist drains.
+// A vertex relaxed more than V times lies on or behind a negative cycle;
+// the search then stops and the results are not shortest paths. With
+// 'cycle' set, the parent tree is checked on every update instead, which
+// stops at the first negative cycle; returns whether one was found.
+bool shortestPaths(const Graph& graph, int source, std::vector<Result>& result, std::vector<int>* cycle)
 {
-    std::vector<Result> result(graph.size(), {-1, 999999});
+    result.assign(graph.size(), {-1, 999999});
     result[source] = {source, 0};
 
-    std::vector<int> verticeToUpdate;
+    std::deque<int> verticeToUpdate;
+    std::vector<bool> queued(graph.size(), false);
+    std::vector<unsigned int> passes(graph.size(), 0);
 
-    for (unsigned int i = 0; i < graph.size(); ++i)
+    verticeToUpdate.push_back(source);
+    queued[source] = true;
+
+    while (!verticeToUpdate.empty())
     {
-        verticeToUpdate.push_back(i);
+        int vertex = verticeToUpdate.front();
+        verticeToUpdate.pop_front();
+        queued[vertex] = false;
+
+        if (++passes[vertex] > graph.size())
+        {
+            return true;
+        }
+
+        if (relax(graph, vertex, result, verticeToUpdate, queued, cycle))
+        {
+            return true;
+        }
     }
 
-    for (unsigned int i = 0; i < graph.size(); ++i)
+    return false;
+}
+
+// Rebuilds the 'from' pointers from converged distances so that they do
+// not depend on the relaxation order: a BFS from the source over tight
+// edges (path[u] + weight == path[v]) gives every vertex the smallest tight
+// predecessor among those one hop closer to the source.
+void canonicalParents(const Graph& graph, int source, std::vector<Result>& result)
+{
+    std::vector<int> hops(graph.size(), -1);
+    std::vector<int> level(1, source);
+    std::vector<int> nextLevel;
+
+    hops[source] = 0;
+    result[source].from = source;
+
+    for (int hop = 1; !level.empty(); ++hop)
     {
-        std::vector<bool> nextRoundUpdate(graph.size(), false);
-        for (unsigned int j = 0; j < graph.size(); ++j)
+        std::sort(level.begin(), level.end());
+        nextLevel.clear();
+
+        for (int vertex: level)
         {
-            relax(graph, j, result, nextRoundUpdate);
+            for (const Edge& edge: graph.connected(vertex))
+            {
+                int next = edge.to();
+                if (hops[next] == -1 && static_cast<int>(result[vertex].path + edge.weight()) == result[next].path)
+                {
+                    hops[next] = hop;
+                    result[next].from = vertex;
+                    nextLevel.push_back(next);
+                }
+            }
         }
 
-        verticeToUpdate.clear();
-        for (unsigned int j = 0; j < nextRoundUpdate.size(); ++j)
+        level.swap(nextLevel);
+    }
+}
+
+// Distances as SPFA computes them, 'from' pointers as canonicalParents
+// picks them: the result does not depend on the order of the edges.
+std::vector<Result> BellmanFord(const Graph& graph, int source)
+{
+    std::vector<Result> result;
+    if (!shortestPaths(graph, source, result, nullptr))
+    {
+        canonicalParents(graph, source, result);
+    }
+    return result;
+}
+
+// (path, from) packed into one word whose integer order is the order of
+// the path, then of the parent; relaxations settle on it with atomic min
+inline uint64_t packResult(int path, int from)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(path) ^ 0x80000000u) << 32) | static_cast<uint32_t>(from);
+}
+
+inline int packedPath(uint64_t packed)
+{
+    return static_cast<int>(static_cast<uint32_t>(packed >> 32) ^ 0x80000000u);
+}
+
+inline int packedFrom(uint64_t packed)
+{
+    return static_cast<int>(static_cast<uint32_t>(packed));
+}
+
+// atomic fetch-min; returns whether 'value' was stored
+bool atomicMin(std::atomic<uint64_t>& target, uint64_t value)
+{
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value < current)
+    {
+        if (target.compare_exchange_weak(current, value, std::memory_order_relaxed))
         {
-            if (nextRoundUpdate[j] == true)
+            return true;
+        }
+    }
+    return false;
+}
+
+// Round-based Bellman-Ford relaxing the out-edges of the frontier (the
+// vertices changed in the previous round) in parallel. The frontier's
+// edges are split evenly across threads, improvements land through atomic
+// min on packed (path, from) words, and changed vertices are collected in
+// a shared bitmap that becomes the next frontier in vertex order. Results
+// match BellmanFord when there is no negative cycle; with one, the search
+// stops after V rounds.
+std::vector<Result> ParallelBellmanFord(const Graph& graph, int source, uint threadCount = 0)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    const size_t size = graph.size();
+    std::vector<std::atomic<uint64_t>> packed(size);
+    for (size_t v = 0; v < size; ++v)
+    {
+        packed[v].store(packResult(999999, -1), std::memory_order_relaxed);
+    }
+    packed[source].store(packResult(0, source), std::memory_order_relaxed);
+
+    std::vector<std::atomic<uint64_t>> changed((size + 63) / 64);
+    std::vector<int> frontier(1, source);
+    std::vector<size_t> firstEdge;
+
+    for (size_t round = 0; round < size && !frontier.empty(); ++round)
+    {
+        // prefix sums of the frontier's out-degrees, to split its edges
+        firstEdge.assign(1, 0);
+        for (int vertex: frontier)
+        {
+            firstEdge.push_back(firstEdge.back() + graph.connected(vertex).size());
+        }
+        const size_t edgeCount = firstEdge.back();
+        const uint threads = std::max<size_t>(1, std::min<size_t>(threadCount, edgeCount / 1024));
+
+        auto relaxRange = [&](size_t begin, size_t end)
+        {
+            size_t i = std::upper_bound(firstEdge.begin(), firstEdge.end(), begin) - firstEdge.begin() - 1;
+            for (size_t e = begin; e < end; ++i)
             {
-                verticeToUpdate.push_back(j);
+                int vertex = frontier[i];
+                const std::vector<Edge>& edges = graph.connected(vertex);
+                int path = packedPath(packed[vertex].load(std::memory_order_relaxed));
+
+                for (size_t j = e - firstEdge[i]; j < edges.size() && e < end; ++j, ++e)
+                {
+                    int next = edges[j].to();
+                    int candidate = path + edges[j].weight();
+                    if (candidate < packedPath(packed[next].load(std::memory_order_relaxed))
+                        && atomicMin(packed[next], packResult(candidate, vertex)))
+                    {
+                        changed[next / 64].fetch_or(uint64_t(1) << (next % 64), std::memory_order_relaxed);
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        const size_t chunk = (edgeCount + threads - 1) / threads;
+        for (uint t = 1; t < threads; ++t)
+        {
+            workers.emplace_back(relaxRange, std::min(edgeCount, t * chunk), std::min(edgeCount, (t + 1) * chunk));
+        }
+        relaxRange(0, std::min(edgeCount, chunk));
+        for (std::thread& worker: workers)
+        {
+            worker.join();
+        }
+
+        frontier.clear();
+        for (size_t word = 0; word < changed.size(); ++word)
+        {
+            uint64_t bits = changed[word].exchange(0, std::memory_order_relaxed);
+            while (bits)
+            {
+                frontier.push_back(word * 64 + __builtin_ctzll(bits));
+                bits &= bits - 1;
             }
         }
     }
 
+    std::vector<Result> result(size);
+    for (size_t v = 0; v < size; ++v)
+    {
+        uint64_t value = packed[v].load(std::memory_order_relaxed);
+        result[v] = {packedFrom(value), packedPath(value)};
+    }
 
+    if (frontier.empty())
+    {
+        canonicalParents(graph, source, result);
+    }
     return result;
 }
 
+// Negative cycle reachable from 'source' as its vertex sequence (each one
+// has an edge to the next, the last one to the first), or an empty vector.
+std::vector<int> findNegativeCycle(const Graph& graph, int source)
+{
+    std::vector<Result> result;
+    std::vector<int> cycle;
+    shortestPaths(graph, source, result, &cycle);
+    return cycle;
+}
+
+
+// LRU cache of BellmanFord trees keyed by source, for workloads where a
+// few sources take most queries. Sources are striped over SHARDS shards,
+// each with its own lock, LRU list and share of the byte budget; shards
+// are padded by a cache line so that threads on different shards do not
+// contend, also on the heap where C++14 ignores the over-alignment. An
+// entry is only returned while the graph still has the version it was
+// computed for, stale ones are dropped when met. Trees are computed
+// outside the lock, so concurrent misses on one source may compute it
+// twice. The graph must not change during a get.
+class ShortestPathCache
+{
+public:
+    typedef std::shared_ptr<const std::vector<Result>> Tree;
+
+    static const uint SHARDS = 16;
+
+    ShortestPathCache(const Graph& graph, size_t byteBudget)
+        : m_Graph(graph)
+        , m_ShardBudget(byteBudget / SHARDS)
+    {}
+
+    ShortestPathCache(const ShortestPathCache&) = delete;
+    ShortestPathCache& operator=(const ShortestPathCache&) = delete;
+
+    Tree get(int source)
+    {
+        assert(source >= 0 && size_t(source) < m_Graph.size());
+        Shard& shard = m_Shards[uint(source) % SHARDS];
+        const uint64_t version = m_Graph.version();
+
+        {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            Tree tree = shard.find(source, version);
+            if (tree)
+            {
+                ++shard.hits;
+                return tree;
+            }
+            ++shard.misses;
+        }
+
+        Tree tree = std::make_shared<const std::vector<Result>>(BellmanFord(m_Graph, source));
+        const size_t bytes = entryBytes(tree->size());
+
+        std::lock_guard<std::mutex> guard(shard.lock);
+        Tree raced = shard.find(source, version);
+        if (raced)
+        {
+            return raced;
+        }
+        if (bytes <= m_ShardBudget)
+        {
+            shard.insert({source, version, tree, bytes}, m_ShardBudget);
+        }
+        return tree;
+    }
+
+    void clear()
+    {
+        for (Shard& shard: m_Shards)
+        {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            shard.lru.clear();
+            shard.index.clear();
+            shard.bytes = 0;
+        }
+    }
+
+    size_t bytes() const { return sum(&Shard::bytes); }
+    size_t hits() const { return sum(&Shard::hits); }
+    size_t misses() const { return sum(&Shard::misses); }
+
+    // budget charged for a cached tree over 'size' vertices: the results,
+    // the shared_ptr control block holding the vector, the LRU list node
+    // (two links and the entry) and the index node (a link, the key and
+    // iterator, and about one bucket pointer)
+    static size_t entryBytes(size_t size)
+    {
+        const size_t tree = 2 * sizeof(long) + sizeof(void*) + sizeof(std::vector<Result>);
+        const size_t listNode = 2 * sizeof(void*) + sizeof(Entry);
+        const size_t indexNode = 2 * sizeof(void*) + sizeof(std::pair<const int, std::list<Entry>::iterator>);
+        return tree + listNode + indexNode + size * sizeof(Result);
+    }
+
+private:
+    struct Entry
+    {
+        int source;
+        uint64_t version;
+        Tree tree;
+        size_t bytes;
+    };
+
+    struct alignas(64) Shard
+    {
+        mutable std::mutex lock;
+        std::list<Entry> lru;
+        std::unordered_map<int, std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+        size_t hits = 0;
+        size_t misses = 0;
+        // alignas(64) is not honoured by new before C++17: the trailing
+        // line keeps the next shard's fields off this shard's lines anyway
+        char padding[64];
+
+        // the tree for 'source' at 'version', moved to the front; a stale
+        // entry is dropped
+        Tree find(int source, uint64_t version)
+        {
+            auto found = index.find(source);
+            if (found == index.end())
+            {
+                return Tree();
+            }
+            if (found->second->version != version)
+            {
+                erase(found->second);
+                return Tree();
+            }
+            lru.splice(lru.begin(), lru, found->second);
+            return found->second->tree;
+        }
+
+        void insert(const Entry& entry, size_t budget)
+        {
+            lru.push_front(entry);
+            index[entry.source] = lru.begin();
+            bytes += entry.bytes;
+
+            while (bytes > budget)
+            {
+                erase(std::prev(lru.end()));
+            }
+        }
+
+        void erase(std::list<Entry>::iterator entry)
+        {
+            bytes -= entry->bytes;
+            index.erase(entry->source);
+            lru.erase(entry);
+        }
+    };
+
+    size_t sum(size_t Shard::* counter) const
+    {
+        size_t total = 0;
+        for (const Shard& shard: m_Shards)
+        {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            total += shard.*counter;
+        }
+        return total;
+    }
+
+    const Graph& m_Graph;
+    const size_t m_ShardBudget;
+    Shard m_Shards[SHARDS];
+};
+
+const uint ShortestPathCache::SHARDS;
+
 
 #include <cppunit/extensions/TestFactoryRegistry.h>
 #include <cppunit/ui/text/TestRunner.h>
@@ -174,6 +574,10 @@ class Test: public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST( test2 );
     CPPUNIT_TEST( test3 );
     CPPUNIT_TEST( test4 );
+    CPPUNIT_TEST( test5 );
+    CPPUNIT_TEST( test6 );
+    CPPUNIT_TEST( test7 );
+    CPPUNIT_TEST( test8 );
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -182,6 +586,10 @@ public:
     void test2();
     void test3();
     void test4();
+    void test5();
+    void test6();
+    void test7();
+    void test8();
 };
 CPPUNIT_TEST_SUITE_REGISTRATION( Test );
 
@@ -252,12 +660,228 @@ void Test::test2()
 
 void Test::test3()
 {
+    // a long chain converges in one pass per vertex; E is unreachable
+    Graph graph(6);
+
+    graph.add('A', 'B', 1);
+    graph.add('B', 'C', 2);
+    graph.add('C', 'D', 3);
+    graph.add('A', 'D', 10);
+    graph.add('D', 'F', -4);
+    graph.add('E', 'A', 1);
+
+    std::vector<Result> expect = {{0, 0}, {0, 1}, {1, 3}, {2, 6}, {-1, 999999}, {3, 2}};
+
+    std::vector<Result> result = BellmanFord(graph, 0);
 
+    CPPUNIT_ASSERT_EQUAL(expect, result);
 }
 
 void Test::test4()
 {
+    // B -> C -> D -> B weighs -1: the search has to terminate anyway
+    Graph graph(4);
+
+    graph.add('A', 'B', 1);
+    graph.add('B', 'C', 1);
+    graph.add('C', 'D', 1);
+    graph.add('D', 'B', -3);
+
+    std::vector<Result> result = BellmanFord(graph, 0);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(4), result.size());
+    CPPUNIT_ASSERT(result[1].path < 1);
+}
+
+void Test::test5()
+{
+    Graph graph(6);
+
+    graph.add('A', 'B', 1);
+    graph.add('B', 'C', 1);
+    graph.add('C', 'D', 1);
+    graph.add('D', 'B', -3);
+    graph.add('A', 'E', 2);
+    graph.add('E', 'F', 2);
+
+    std::vector<int> cycle = findNegativeCycle(graph, 0);
+
+    // the same cycle, whichever vertex it was closed at
+    CPPUNIT_ASSERT_EQUAL(size_t(3), cycle.size());
+    std::rotate(cycle.begin(), std::min_element(cycle.begin(), cycle.end()), cycle.end());
+    std::vector<int> expect = {1, 2, 3};
+    CPPUNIT_ASSERT_EQUAL(expect, cycle);
+
+    // no cycle reachable: E -> A -> E is negative but not reachable from B
+    Graph acyclic(5);
+    acyclic.add('B', 'C', 4);
+    acyclic.add('C', 'D', -2);
+    acyclic.add('B', 'D', 3);
+    acyclic.add('E', 'A', -5);
+    acyclic.add('A', 'E', 1);
+
+    CPPUNIT_ASSERT(findNegativeCycle(acyclic, 1).empty());
+    CPPUNIT_ASSERT(findNegativeCycle(acyclic, 0).size() == 2);
+
+    // a negative self loop
+    Graph loop(2);
+    loop.add('A', 'B', 1);
+    loop.add('B', 'B', -1);
+
+    expect = {1};
+    CPPUNIT_ASSERT_EQUAL(expect, findNegativeCycle(loop, 0));
+}
+
+void Test::test6()
+{
+    Graph graph(8);
+
+    graph.add(0, 1, 5);
+    graph.add(0, 4, 9);
+    graph.add(0, 7, 8);
+    graph.add(1, 2, 12);
+    graph.add(1, 3, 15);
+    graph.add(1, 7, 4);
+    graph.add(2, 3, 3);
+    graph.add(2, 6, 11);
+    graph.add(3, 6, 9);
+    graph.add(4, 5, 4);
+    graph.add(4, 6, 20);
+    graph.add(4, 7, 5);
+    graph.add(5, 2, 1);
+    graph.add(5, 6, 13);
+    graph.add(7, 2, 7);
+    graph.add(7, 5, 6);
+
+    std::vector<Result> expect = {{0, 0}, {0, 5}, {5, 14}, {2, 17}, {0, 9}, {4, 13}, {2, 25}, {0, 8}};
+
+    CPPUNIT_ASSERT_EQUAL(expect, ParallelBellmanFord(graph, 0, 4));
+
+    // a grid with many equal-length paths, negative edges going down and
+    // zero-weight cycles between some horizontal neighbours
+    const int side = 60;
+    Graph grid(side * side);
+    uint32_t seed = 9;
+    for (int r = 0; r < side; ++r)
+    {
+        for (int c = 0; c < side; ++c)
+        {
+            int v = r * side + c;
+            seed = seed * 1103515245 + 12345;
+            int right = (seed >> 8) % 3;
+            if (c + 1 < side) grid.add(v, v + 1, float(right));
+            if (c + 1 < side && right == 0) grid.add(v + 1, v, 0.0f);
+            if (r + 1 < side) grid.add(v, v + side, float(int((seed >> 12) % 4) - 1));
+        }
+    }
+
+    CPPUNIT_ASSERT(findNegativeCycle(grid, 0).empty());
+
+    std::vector<Result> sequential = BellmanFord(grid, 0);
+    CPPUNIT_ASSERT(sequential == ParallelBellmanFord(grid, 0, 1));
+    CPPUNIT_ASSERT(sequential == ParallelBellmanFord(grid, 0, 4));
+
+    Graph positive(side * side);
+    for (int v = 0; v + 1 < side * side; ++v)
+    {
+        seed = seed * 1103515245 + 12345;
+        positive.add(v, v + 1, float((seed >> 8) % 3));
+        positive.add(v, (seed >> 12) % (side * side), float((seed >> 16) % 5));
+    }
+
+    sequential = BellmanFord(positive, 0);
+    CPPUNIT_ASSERT(sequential == ParallelBellmanFord(positive, 0, 4));
+}
+
+void Test::test7()
+{
+    Graph graph(5);
+
+    graph.add('A', 'B', 4);
+    graph.add('B', 'C', -2);
+    graph.add('A', 'C', 3);
+    graph.add('C', 'D', 1);
+    graph.add('D', 'E', 5);
+
+    // room for two trees in the shard of 0 and 16, but not three
+    const size_t tree = ShortestPathCache::entryBytes(5);
+    ShortestPathCache cache(graph, ShortestPathCache::SHARDS * 2 * tree + ShortestPathCache::SHARDS);
+
+    ShortestPathCache::Tree first = cache.get(0);
+    CPPUNIT_ASSERT(BellmanFord(graph, 0) == *first);
+    CPPUNIT_ASSERT(first == cache.get(0));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), cache.hits());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), cache.misses());
+
+    // a new edge makes every cached tree stale
+    graph.add('A', 'E', 1);
+    ShortestPathCache::Tree second = cache.get(0);
+    CPPUNIT_ASSERT(first != second);
+    CPPUNIT_ASSERT(BellmanFord(graph, 0) == *second);
+    Result expect = {0, 1};
+    CPPUNIT_ASSERT_EQUAL(expect, (*second)[4]);
+    expect = {3, 8};
+    CPPUNIT_ASSERT_EQUAL(expect, (*first)[4]);
+
+    // 0, 1 and 2 land in different shards, each within its budget
+    cache.get(1);
+    cache.get(2);
+    CPPUNIT_ASSERT(second == cache.get(0));
+
+    cache.clear();
+    CPPUNIT_ASSERT_EQUAL(size_t(0), cache.bytes());
+    CPPUNIT_ASSERT(second != cache.get(0));
+}
+
+void Test::test8()
+{
+    // one tree per shard: a miss in a shard evicts its previous tree
+    const int size = 40;
+    Graph graph(size);
+    for (int v = 0; v + 1 < size; ++v)
+    {
+        graph.add(v, v + 1, (v % 3) - 1);
+        graph.add(v + 1, v, 2);
+    }
+
+    const size_t tree = ShortestPathCache::entryBytes(size);
+    ShortestPathCache cache(graph, ShortestPathCache::SHARDS * (tree + tree / 2));
+
+    std::vector<std::vector<Result>> expect;
+    for (int source = 0; source < size; ++source)
+    {
+        expect.push_back(BellmanFord(graph, source));
+    }
+
+    cache.get(0);
+    cache.get(16);
+    cache.get(0);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), cache.hits());
+
+    std::vector<std::thread> workers;
+    std::atomic<int> wrong(0);
+    for (int t = 0; t < 4; ++t)
+    {
+        workers.emplace_back([&, t]()
+        {
+            for (int i = 0; i < 2000; ++i)
+            {
+                int source = (i * 7 + t) % 5 == 0 ? (i + t) % size : (i + t) % 3;
+                if (*cache.get(source) != expect[source])
+                {
+                    ++wrong;
+                }
+            }
+        });
+    }
+    for (std::thread& worker: workers)
+    {
+        worker.join();
+    }
 
+    CPPUNIT_ASSERT_EQUAL(0, wrong.load());
+    CPPUNIT_ASSERT(cache.hits() > cache.misses());
+    CPPUNIT_ASSERT(cache.bytes() <= ShortestPathCache::SHARDS * (tree + tree / 2));
 }
 
 int main()
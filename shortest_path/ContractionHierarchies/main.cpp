@@ -0,0 +1,1033 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <assert.h>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <iterator>
+
+#include "../../common/DaryHeap.h"
+
+using namespace std;
+
+typedef unsigned int uint;
+
+class Edge
+{
+    int m_from, m_to;
+    float m_weight;
+public:
+    Edge(int from, int to, float weight)
+        : m_from(from), m_to(to), m_weight(weight)
+    { }
+
+    Edge(char from, char to, float weight)
+        : m_from(from - 'A'), m_to(to - 'A'), m_weight(weight)
+    { }
+
+    int from() const { return m_from; }
+    int to() const { return m_to; }
+    float weight() const { return m_weight; }
+};
+
+
+class Graph
+{
+    std::vector< std::vector<Edge> > m_edges;
+public:
+    Graph(int size)
+        : m_edges(size)
+    { }
+
+    size_t size() const { return m_edges.size(); }
+
+    void add(const Edge& e) { m_edges[e.from()].push_back(e); }
+    void add(int from, int to, float weight)
+    { 
+        Edge e(from, to, weight);
+        add(e);
+    }
+
+    void add(char from, char to, float weight)
+    { 
+        Edge e(from, to, weight);
+        add(e);
+    }
+
+    const std::vector<Edge>& connected(int vertex) const 
+    {
+        return m_edges[vertex];
+    }
+};
+
+// An arc of the hierarchy. Shortcuts remember the contracted vertex they
+// bypass in 'middle', original edges have -1 there.
+struct HierarchyArc
+{
+    int to;
+    float weight;
+    int middle;
+};
+
+struct QueuedVertex
+{
+    int vertex;
+    float path;
+};
+
+bool operator<(const QueuedVertex& left, const QueuedVertex& right)
+{
+    return left.path < right.path || (left.path == right.path && left.vertex < right.vertex);
+}
+
+struct QueuedVertexKey
+{
+    int operator()(const QueuedVertex& queued) const
+    {
+        return queued.vertex;
+    }
+};
+
+typedef DaryHeap<QueuedVertex, 4, std::less<QueuedVertex>, KeyIndex<QueuedVertexKey>> Heap;
+
+// Distances of one Dijkstra search that can be reset in time proportional
+// to the vertices it touched.
+class SearchSpace
+{
+public:
+    explicit SearchSpace(size_t size)
+        : m_Distance(size, INFINITY)
+        , m_Parent(size, -1)
+        , m_Touched()
+        , m_Heap(size)
+    {}
+
+    float distance(int vertex) const { return m_Distance[vertex]; }
+    int parent(int vertex) const { return m_Parent[vertex]; }
+    Heap& heap() { return m_Heap; }
+
+    bool improve(int vertex, float distance, int parent)
+    {
+        if (distance >= m_Distance[vertex])
+        {
+            return false;
+        }
+        if (m_Distance[vertex] == INFINITY)
+        {
+            m_Touched.push_back(vertex);
+        }
+        m_Distance[vertex] = distance;
+        m_Parent[vertex] = parent;
+        m_Heap.pushOrDecrease({vertex, distance});
+        return true;
+    }
+
+    void reset()
+    {
+        for (int vertex: m_Touched)
+        {
+            m_Distance[vertex] = INFINITY;
+            m_Parent[vertex] = -1;
+        }
+        m_Touched.clear();
+        m_Heap.clear();
+    }
+
+private:
+    std::vector<float> m_Distance;
+    std::vector<int> m_Parent;
+    std::vector<int> m_Touched;
+    Heap m_Heap;
+};
+
+// Runs fn(thread, index) for index in 0 .. count - 1 on up to
+// 'threadCount' threads.
+template <class Function>
+void parallelFor(size_t count, uint threadCount, Function fn)
+{
+    std::atomic<size_t> next(0);
+    auto worker = [&](uint thread)
+    {
+        for (size_t index; (index = next++) < count; )
+        {
+            fn(thread, index);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (uint t = 1; t < std::min<size_t>(threadCount, count); ++t)
+    {
+        workers.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread& thread: workers)
+    {
+        thread.join();
+    }
+}
+
+// Static upward search graph of a contraction hierarchy: for every vertex
+// the arcs to higher-ranked vertices ('up') and the arcs from
+// higher-ranked vertices ('down', stored at their head), both in CSR form.
+class ContractionHierarchy
+{
+public:
+    ContractionHierarchy() {}
+
+    // Contracts the vertices of 'graph' in rounds, see Contraction below.
+    // Edge weights must not be negative.
+    explicit ContractionHierarchy(const Graph& graph, uint threadCount = 0);
+
+    size_t size() const { return m_Rank.size(); }
+    size_t shortcutCount() const { return m_ShortcutCount; }
+    int rank(int vertex) const { return m_Rank[vertex]; }
+
+    const HierarchyArc* upBegin(int vertex) const { return m_Up.data() + m_UpOffsets[vertex]; }
+    const HierarchyArc* upEnd(int vertex) const { return m_Up.data() + m_UpOffsets[vertex + 1]; }
+    const HierarchyArc* downBegin(int vertex) const { return m_Down.data() + m_DownOffsets[vertex]; }
+    const HierarchyArc* downEnd(int vertex) const { return m_Down.data() + m_DownOffsets[vertex + 1]; }
+
+    // Raw binary image: a header, then the arrays as they are in memory.
+    // Both throw std::runtime_error on I/O errors or a foreign file.
+    void save(const std::string& fileName) const;
+    void load(const std::string& fileName);
+
+    // Appends the original vertices of arc from -> arc.to, 'from' excluded.
+    void unpack(int from, const HierarchyArc& arc, std::vector<int>& path) const;
+
+private:
+    friend class Contraction;
+
+    static const uint32_t MAGIC = 0x48434831; // "1HCH"
+
+    std::vector<int> m_Rank;
+    std::vector<uint32_t> m_UpOffsets;
+    std::vector<HierarchyArc> m_Up;
+    std::vector<uint32_t> m_DownOffsets;
+    std::vector<HierarchyArc> m_Down;
+    size_t m_ShortcutCount = 0;
+};
+
+const uint32_t ContractionHierarchy::MAGIC;
+
+// Builds a ContractionHierarchy. Every round recomputes the priority (edge
+// difference plus the number of contracted neighbours) of the vertices
+// whose neighbourhood changed, picks the vertices whose priority is lower
+// than that of all their remaining neighbours, finds their shortcuts with
+// bounded witness searches, and then inserts them. The first and third
+// steps run in parallel; the rounds themselves do not depend on the
+// thread count.
+class Contraction
+{
+public:
+    static const size_t SETTLE_LIMIT = 500;
+
+    Contraction(const Graph& graph, uint threadCount)
+        : m_Out(graph.size())
+        , m_In(graph.size())
+        , m_Contracted(graph.size(), false)
+        , m_ContractedNeighbours(graph.size(), 0)
+        , m_Priority(graph.size(), 0)
+        , m_ThreadCount(threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency()))
+    {
+        for (size_t vertex = 0; vertex < graph.size(); ++vertex)
+        {
+            for (const Edge& edge: graph.connected(vertex))
+            {
+                assert(edge.weight() >= 0);
+                if (edge.to() != static_cast<int>(vertex))
+                {
+                    addArc(vertex, {edge.to(), edge.weight(), -1});
+                }
+            }
+        }
+
+        for (uint t = 0; t < m_ThreadCount; ++t)
+        {
+            m_Spaces.emplace_back(graph.size());
+        }
+    }
+
+    void run(ContractionHierarchy& hierarchy)
+    {
+        const int size = m_Out.size();
+        std::vector<int> dirty(size);
+        for (int vertex = 0; vertex < size; ++vertex)
+        {
+            dirty[vertex] = vertex;
+        }
+
+        hierarchy.m_Rank.assign(size, -1);
+        int nextRank = 0;
+
+        while (nextRank < size)
+        {
+            parallelFor(dirty.size(), m_ThreadCount, [&](uint thread, size_t index)
+            {
+                int vertex = dirty[index];
+                std::vector<std::pair<int, HierarchyArc>> shortcuts;
+                findShortcuts(vertex, m_Spaces[thread], shortcuts);
+                m_Priority[vertex] = static_cast<int>(shortcuts.size()) - degree(vertex)
+                                   + m_ContractedNeighbours[vertex];
+            });
+
+            std::vector<int> selected;
+            for (int vertex = 0; vertex < size; ++vertex)
+            {
+                if (!m_Contracted[vertex] && isLocalMinimum(vertex))
+                {
+                    selected.push_back(vertex);
+                }
+            }
+
+            // no two selected vertices are adjacent, but a witness path may
+            // run through another one of them: mark them all beforehand, or
+            // each could rely on the other and both drop the shortcut
+            for (int vertex: selected)
+            {
+                m_Contracted[vertex] = true;
+            }
+
+            std::vector<std::vector<std::pair<int, HierarchyArc>>> shortcuts(selected.size());
+            parallelFor(selected.size(), m_ThreadCount, [&](uint thread, size_t index)
+            {
+                findShortcuts(selected[index], m_Spaces[thread], shortcuts[index]);
+            });
+
+            std::vector<bool> marked(size, false);
+            dirty.clear();
+            for (size_t i = 0; i < selected.size(); ++i)
+            {
+                int vertex = selected[i];
+                hierarchy.m_Rank[vertex] = nextRank++;
+
+                for (const auto& shortcut: shortcuts[i])
+                {
+                    addArc(shortcut.first, shortcut.second);
+                }
+                forNeighbours(vertex, [&](int neighbour)
+                {
+                    ++m_ContractedNeighbours[neighbour];
+                    if (!marked[neighbour])
+                    {
+                        marked[neighbour] = true;
+                        dirty.push_back(neighbour);
+                    }
+                });
+            }
+            dirty.erase(std::remove_if(dirty.begin(), dirty.end(), [&](int vertex) { return m_Contracted[vertex]; }),
+                        dirty.end());
+        }
+
+        buildSearchGraph(hierarchy);
+    }
+
+private:
+    // adds from -> arc.to, or lowers the weight of the arc already there
+    void addArc(int from, const HierarchyArc& arc)
+    {
+        for (HierarchyArc& out: m_Out[from])
+        {
+            if (out.to == arc.to)
+            {
+                if (arc.weight < out.weight)
+                {
+                    out.weight = arc.weight;
+                    out.middle = arc.middle;
+                    for (HierarchyArc& in: m_In[arc.to])
+                    {
+                        if (in.to == from)
+                        {
+                            in.weight = arc.weight;
+                            in.middle = arc.middle;
+                        }
+                    }
+                }
+                return;
+            }
+        }
+
+        m_Out[from].push_back(arc);
+        m_In[arc.to].push_back({from, arc.weight, arc.middle});
+    }
+
+    template <class Function>
+    void forNeighbours(int vertex, Function fn) const
+    {
+        for (const HierarchyArc& arc: m_Out[vertex])
+        {
+            if (!m_Contracted[arc.to])
+            {
+                fn(arc.to);
+            }
+        }
+        for (const HierarchyArc& arc: m_In[vertex])
+        {
+            if (!m_Contracted[arc.to])
+            {
+                fn(arc.to);
+            }
+        }
+    }
+
+    int degree(int vertex) const
+    {
+        int degree = 0;
+        forNeighbours(vertex, [&](int) { ++degree; });
+        return degree;
+    }
+
+    bool isLocalMinimum(int vertex) const
+    {
+        bool minimum = true;
+        forNeighbours(vertex, [&](int neighbour)
+        {
+            if (m_Priority[neighbour] < m_Priority[vertex] ||
+                (m_Priority[neighbour] == m_Priority[vertex] && neighbour < vertex))
+            {
+                minimum = false;
+            }
+        });
+        return minimum;
+    }
+
+    // Shortcuts (from, arc) needed to contract 'vertex': u -> vertex -> w
+    // becomes u -> w unless a search from u that avoids 'vertex' finds a
+    // path no longer. The searches settle at most SETTLE_LIMIT vertices;
+    // a missed witness only costs a superfluous shortcut.
+    void findShortcuts(int vertex, SearchSpace& space, std::vector<std::pair<int, HierarchyArc>>& shortcuts) const
+    {
+        float longestOut = 0;
+        for (const HierarchyArc& out: m_Out[vertex])
+        {
+            if (!m_Contracted[out.to])
+            {
+                longestOut = std::max(longestOut, out.weight);
+            }
+        }
+
+        for (const HierarchyArc& in: m_In[vertex])
+        {
+            int from = in.to;
+            if (m_Contracted[from])
+            {
+                continue;
+            }
+
+            witnessSearch(from, vertex, in.weight + longestOut, space);
+
+            for (const HierarchyArc& out: m_Out[vertex])
+            {
+                if (!m_Contracted[out.to] && out.to != from && in.weight + out.weight < space.distance(out.to))
+                {
+                    shortcuts.push_back({from, {out.to, in.weight + out.weight, vertex}});
+                }
+            }
+        }
+    }
+
+    void witnessSearch(int source, int avoided, float limit, SearchSpace& space) const
+    {
+        space.reset();
+        space.improve(source, 0, source);
+
+        for (size_t settled = 0; !space.heap().empty() && settled < SETTLE_LIMIT; ++settled)
+        {
+            QueuedVertex current = space.heap().pop();
+            if (current.path > limit)
+            {
+                break;
+            }
+
+            for (const HierarchyArc& arc: m_Out[current.vertex])
+            {
+                if (arc.to != avoided && !m_Contracted[arc.to])
+                {
+                    space.improve(arc.to, current.path + arc.weight, current.vertex);
+                }
+            }
+        }
+    }
+
+    void buildSearchGraph(ContractionHierarchy& hierarchy) const
+    {
+        const std::vector<int>& rank = hierarchy.m_Rank;
+        const size_t size = m_Out.size();
+
+        hierarchy.m_UpOffsets.assign(1, 0);
+        hierarchy.m_DownOffsets.assign(1, 0);
+        hierarchy.m_Up.clear();
+        hierarchy.m_Down.clear();
+        hierarchy.m_ShortcutCount = 0;
+
+        for (size_t vertex = 0; vertex < size; ++vertex)
+        {
+            for (const HierarchyArc& arc: m_Out[vertex])
+            {
+                if (rank[arc.to] > rank[vertex])
+                {
+                    hierarchy.m_Up.push_back(arc);
+                }
+                hierarchy.m_ShortcutCount += arc.middle != -1;
+            }
+            for (const HierarchyArc& arc: m_In[vertex])
+            {
+                if (rank[arc.to] > rank[vertex])
+                {
+                    hierarchy.m_Down.push_back(arc);
+                }
+            }
+            hierarchy.m_UpOffsets.push_back(hierarchy.m_Up.size());
+            hierarchy.m_DownOffsets.push_back(hierarchy.m_Down.size());
+        }
+    }
+
+    std::vector<std::vector<HierarchyArc>> m_Out;
+    std::vector<std::vector<HierarchyArc>> m_In;
+    std::vector<bool> m_Contracted;
+    std::vector<int> m_ContractedNeighbours;
+    std::vector<int> m_Priority;
+    std::vector<SearchSpace> m_Spaces;
+    uint m_ThreadCount;
+};
+
+const size_t Contraction::SETTLE_LIMIT;
+
+ContractionHierarchy::ContractionHierarchy(const Graph& graph, uint threadCount)
+{
+    Contraction(graph, threadCount).run(*this);
+}
+
+void ContractionHierarchy::unpack(int from, const HierarchyArc& arc, std::vector<int>& path) const
+{
+    if (arc.middle == -1)
+    {
+        path.push_back(arc.to);
+        return;
+    }
+
+    // both halves lead up from the middle vertex, which was contracted first
+    const int middle = arc.middle;
+    const HierarchyArc* first = nullptr;
+    const HierarchyArc* second = nullptr;
+
+    for (const HierarchyArc* down = downBegin(middle); down != downEnd(middle); ++down)
+    {
+        if (down->to == from)
+        {
+            first = down;
+        }
+    }
+    for (const HierarchyArc* up = upBegin(middle); up != upEnd(middle); ++up)
+    {
+        if (up->to == arc.to)
+        {
+            second = up;
+        }
+    }
+    assert(first && second);
+
+    unpack(from, {middle, first->weight, first->middle}, path);
+    unpack(middle, *second, path);
+}
+
+template <class T>
+void writeArray(std::ofstream& file, const std::vector<T>& values)
+{
+    uint64_t count = values.size();
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    file.write(reinterpret_cast<const char*>(values.data()), count * sizeof(T));
+}
+
+template <class T>
+void readArray(std::ifstream& file, std::vector<T>& values)
+{
+    uint64_t count = 0;
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    values.resize(file ? count : 0);
+    file.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(T));
+}
+
+// Whether 'offsets' split 'arcs' into per-vertex ranges, rising from 0 to
+// arcs.size(), and every arc stays within the 'size' vertices.
+bool validArcs(const std::vector<uint32_t>& offsets, const std::vector<HierarchyArc>& arcs, size_t size)
+{
+    if (offsets.empty() || offsets.front() != 0 || offsets.back() != arcs.size() ||
+        !std::is_sorted(offsets.begin(), offsets.end()))
+    {
+        return false;
+    }
+
+    for (const HierarchyArc& arc: arcs)
+    {
+        if (arc.to < 0 || size_t(arc.to) >= size || arc.middle < -1 || (arc.middle >= 0 && size_t(arc.middle) >= size))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ContractionHierarchy::save(const std::string& fileName) const
+{
+    std::ofstream file(fileName.c_str(), std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        throw std::runtime_error("cannot create hierarchy file " + fileName);
+    }
+
+    uint64_t header[2] = {MAGIC, m_ShortcutCount};
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    writeArray(file, m_Rank);
+    writeArray(file, m_UpOffsets);
+    writeArray(file, m_Up);
+    writeArray(file, m_DownOffsets);
+    writeArray(file, m_Down);
+
+    if (!file)
+    {
+        throw std::runtime_error("cannot write hierarchy file " + fileName);
+    }
+}
+
+void ContractionHierarchy::load(const std::string& fileName)
+{
+    std::ifstream file(fileName.c_str(), std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("cannot open hierarchy file " + fileName);
+    }
+
+    uint64_t header[2] = {0, 0};
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!file || header[0] != MAGIC)
+    {
+        throw std::runtime_error("not a hierarchy file: " + fileName);
+    }
+
+    m_ShortcutCount = header[1];
+    readArray(file, m_Rank);
+    readArray(file, m_UpOffsets);
+    readArray(file, m_Up);
+    readArray(file, m_DownOffsets);
+    readArray(file, m_Down);
+
+    if (!file || m_UpOffsets.size() != m_Rank.size() + 1 || m_DownOffsets.size() != m_Rank.size() + 1)
+    {
+        throw std::runtime_error("truncated hierarchy file " + fileName);
+    }
+
+    const size_t size = m_Rank.size();
+    bool ranked = std::all_of(m_Rank.begin(), m_Rank.end(),
+                              [size](int rank) { return rank >= 0 && size_t(rank) < size; });
+    if (!ranked || !validArcs(m_UpOffsets, m_Up, size) || !validArcs(m_DownOffsets, m_Down, size))
+    {
+        throw std::runtime_error("corrupt hierarchy file " + fileName);
+    }
+}
+
+// Point-to-point queries on a hierarchy: a forward search up from the
+// source and a backward search up from the target, alternating until
+// neither can beat the best meeting vertex. One query object per thread;
+// it keeps its search spaces between queries.
+class HierarchyQuery
+{
+public:
+    explicit HierarchyQuery(const ContractionHierarchy& hierarchy)
+        : m_Hierarchy(hierarchy)
+        , m_Forward(hierarchy.size())
+        , m_Backward(hierarchy.size())
+    {}
+
+    // INFINITY when 'target' cannot be reached
+    float distance(int source, int target)
+    {
+        int meeting = search(source, target);
+        return meeting == -1 ? INFINITY : m_Forward.distance(meeting) + m_Backward.distance(meeting);
+    }
+
+    // vertices of a shortest path, both ends included; empty when
+    // 'target' cannot be reached
+    std::vector<int> path(int source, int target)
+    {
+        std::vector<int> path;
+        int meeting = search(source, target);
+        if (meeting == -1)
+        {
+            return path;
+        }
+
+        std::vector<int> upward;
+        for (int vertex = meeting; vertex != source; vertex = m_Forward.parent(vertex))
+        {
+            upward.push_back(vertex);
+        }
+
+        path.push_back(source);
+        for (int from = source; !upward.empty(); upward.pop_back())
+        {
+            int to = upward.back();
+            m_Hierarchy.unpack(from, arcBetween(m_Hierarchy.upBegin(from), m_Hierarchy.upEnd(from), to), path);
+            from = to;
+        }
+        for (int from = meeting; from != target; )
+        {
+            int to = m_Backward.parent(from);
+            HierarchyArc arc = arcBetween(m_Hierarchy.downBegin(to), m_Hierarchy.downEnd(to), from);
+            m_Hierarchy.unpack(from, {to, arc.weight, arc.middle}, path);
+            from = to;
+        }
+        return path;
+    }
+
+private:
+    // the lightest arc to 'to' in [begin, end); for a down arc the result
+    // is turned around to point from 'to' to the vertex holding it
+    static HierarchyArc arcBetween(const HierarchyArc* begin, const HierarchyArc* end, int to)
+    {
+        HierarchyArc best = {-1, INFINITY, -1};
+        for (const HierarchyArc* arc = begin; arc != end; ++arc)
+        {
+            if (arc->to == to && arc->weight < best.weight)
+            {
+                best = *arc;
+            }
+        }
+        assert(best.to != -1);
+        return best;
+    }
+
+    int search(int source, int target)
+    {
+        m_Forward.reset();
+        m_Backward.reset();
+        m_Forward.improve(source, 0, source);
+        m_Backward.improve(target, 0, target);
+
+        float best = INFINITY;
+        int meeting = -1;
+        bool forward = true;
+
+        while (true)
+        {
+            Heap& forwardHeap = m_Forward.heap();
+            Heap& backwardHeap = m_Backward.heap();
+            bool forwardOpen = !forwardHeap.empty() && forwardHeap.top().path < best;
+            bool backwardOpen = !backwardHeap.empty() && backwardHeap.top().path < best;
+            if (!forwardOpen && !backwardOpen)
+            {
+                break;
+            }
+            forward = forwardOpen && (forward || !backwardOpen);
+
+            SearchSpace& space = forward ? m_Forward : m_Backward;
+            const SearchSpace& other = forward ? m_Backward : m_Forward;
+            QueuedVertex current = space.heap().pop();
+
+            if (current.path + other.distance(current.vertex) < best)
+            {
+                best = current.path + other.distance(current.vertex);
+                meeting = current.vertex;
+            }
+
+            const HierarchyArc* begin = forward ? m_Hierarchy.upBegin(current.vertex) : m_Hierarchy.downBegin(current.vertex);
+            const HierarchyArc* end = forward ? m_Hierarchy.upEnd(current.vertex) : m_Hierarchy.downEnd(current.vertex);
+            for (const HierarchyArc* arc = begin; arc != end; ++arc)
+            {
+                space.improve(arc->to, current.path + arc->weight, current.vertex);
+            }
+
+            forward = !forward;
+        }
+
+        return meeting;
+    }
+
+    const ContractionHierarchy& m_Hierarchy;
+    SearchSpace m_Forward;
+    SearchSpace m_Backward;
+};
+
+
+std::ostream& operator<<(std::ostream& os, const std::vector<int>& v)
+{
+    os << '[';
+
+    if (!v.empty())
+    {
+        os << v[0];
+
+        for (auto it = v.begin()+1; it != v.end(); ++it)
+        {
+            os << ", " << *it;
+        }
+    }
+    os << ']';
+    return os;
+}
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test: public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE( Test ); 
+
+    CPPUNIT_TEST( test1 );
+    CPPUNIT_TEST( test2 );
+    CPPUNIT_TEST( test3 );
+    CPPUNIT_TEST( test4 );
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void test1();
+    void test2();
+    void test3();
+    void test4();
+};
+CPPUNIT_TEST_SUITE_REGISTRATION( Test );
+
+std::vector<float> referenceDistances(const Graph& graph, int source)
+{
+    std::vector<float> distance(graph.size(), INFINITY);
+    std::vector<bool> done(graph.size(), false);
+    distance[source] = 0;
+
+    for (size_t round = 0; round < graph.size(); ++round)
+    {
+        int vertex = -1;
+        for (size_t v = 0; v < graph.size(); ++v)
+        {
+            if (!done[v] && distance[v] != INFINITY && (vertex == -1 || distance[v] < distance[vertex]))
+            {
+                vertex = v;
+            }
+        }
+        if (vertex == -1)
+        {
+            break;
+        }
+
+        done[vertex] = true;
+        for (const Edge& edge: graph.connected(vertex))
+        {
+            distance[edge.to()] = std::min(distance[edge.to()], distance[vertex] + edge.weight());
+        }
+    }
+
+    return distance;
+}
+
+// length of 'path' in 'graph', INFINITY if some hop is not an edge
+float pathLength(const Graph& graph, const std::vector<int>& path)
+{
+    float length = 0;
+    for (size_t i = 1; i < path.size(); ++i)
+    {
+        float hop = INFINITY;
+        for (const Edge& edge: graph.connected(path[i - 1]))
+        {
+            if (edge.to() == path[i])
+            {
+                hop = std::min(hop, edge.weight());
+            }
+        }
+        length += hop;
+    }
+    return length;
+}
+
+Graph gridGraph(int side)
+{
+    Graph graph(side * side);
+
+    for (int row = 0; row < side; ++row)
+    {
+        for (int column = 0; column < side; ++column)
+        {
+            int vertex = row * side + column;
+            if (column + 1 < side)
+            {
+                graph.add(vertex, vertex + 1, (vertex * 7) % 10 + 1);
+                graph.add(vertex + 1, vertex, (vertex * 3) % 10 + 1);
+            }
+            if (row + 1 < side)
+            {
+                graph.add(vertex, vertex + side, (vertex * 5) % 10 + 1);
+                graph.add(vertex + side, vertex, (vertex * 11) % 10 + 1);
+            }
+        }
+    }
+
+    return graph;
+}
+
+void checkAllPairs(const Graph& graph, const ContractionHierarchy& hierarchy)
+{
+    HierarchyQuery query(hierarchy);
+
+    for (size_t source = 0; source < graph.size(); ++source)
+    {
+        std::vector<float> expect = referenceDistances(graph, source);
+
+        for (size_t target = 0; target < graph.size(); ++target)
+        {
+            CPPUNIT_ASSERT_EQUAL(expect[target], query.distance(source, target));
+
+            std::vector<int> path = query.path(source, target);
+            if (expect[target] == INFINITY)
+            {
+                CPPUNIT_ASSERT(path.empty());
+                continue;
+            }
+            CPPUNIT_ASSERT_EQUAL(int(source), path.front());
+            CPPUNIT_ASSERT_EQUAL(int(target), path.back());
+            CPPUNIT_ASSERT_EQUAL(expect[target], pathLength(graph, path));
+        }
+    }
+}
+
+void Test::test1()
+{
+    Graph graph(8);
+
+    graph.add(0, 1, 5);
+    graph.add(0, 4, 9);
+    graph.add(0, 7, 8);
+
+    graph.add(1, 2, 12);
+    graph.add(1, 3, 15);
+    graph.add(1, 7, 4);
+
+    graph.add(2, 3, 3);
+    graph.add(2, 6, 11);
+
+    graph.add(3, 6, 9);
+
+    graph.add(4, 5, 4);
+    graph.add(4, 6, 20);
+    graph.add(4, 7, 5);
+
+    graph.add(5, 2, 1);
+    graph.add(5, 6, 13);
+
+    graph.add(7, 2, 7);
+    graph.add(7, 5, 6);
+
+    ContractionHierarchy hierarchy(graph);
+    HierarchyQuery query(hierarchy);
+
+    CPPUNIT_ASSERT_EQUAL(25.0f, query.distance(0, 6));
+    std::vector<int> path = {0, 4, 5, 2, 6};
+    CPPUNIT_ASSERT_EQUAL(path, query.path(0, 6));
+    CPPUNIT_ASSERT_EQUAL(float(INFINITY), query.distance(6, 0));
+
+    checkAllPairs(graph, hierarchy);
+}
+
+void Test::test2()
+{
+    // contraction rounds do not depend on the thread count
+    Graph graph = gridGraph(12);
+
+    ContractionHierarchy single(graph, 1);
+    ContractionHierarchy parallel(graph, 4);
+
+    CPPUNIT_ASSERT(single.shortcutCount() > 0);
+    CPPUNIT_ASSERT_EQUAL(single.shortcutCount(), parallel.shortcutCount());
+    for (size_t vertex = 0; vertex < graph.size(); ++vertex)
+    {
+        CPPUNIT_ASSERT_EQUAL(single.rank(vertex), parallel.rank(vertex));
+    }
+
+    checkAllPairs(graph, parallel);
+}
+
+void Test::test3()
+{
+    // two components, parallel edges and a self loop
+    Graph graph(6);
+
+    graph.add('A', 'B', 4);
+    graph.add('A', 'B', 2);
+    graph.add('B', 'C', 1);
+    graph.add('C', 'A', 1);
+    graph.add('C', 'C', 0);
+    graph.add('D', 'E', 3);
+    graph.add('E', 'F', 3);
+    graph.add('F', 'D', 3);
+
+    ContractionHierarchy hierarchy(graph, 2);
+    checkAllPairs(graph, hierarchy);
+}
+
+void Test::test4()
+{
+    Graph graph = gridGraph(8);
+    ContractionHierarchy built(graph);
+
+    const std::string fileName = "ch_test_hierarchy.bin";
+    built.save(fileName);
+
+    ContractionHierarchy loaded;
+    loaded.load(fileName);
+
+    CPPUNIT_ASSERT_EQUAL(built.size(), loaded.size());
+    CPPUNIT_ASSERT_EQUAL(built.shortcutCount(), loaded.shortcutCount());
+    checkAllPairs(graph, loaded);
+
+    CPPUNIT_ASSERT_THROW(loaded.load("ch_test_missing.bin"), std::runtime_error);
+
+    // offsets that overrun the arcs and arcs that leave the graph are
+    // rejected: header, then each array as its count and its items
+    std::string image;
+    {
+        std::ifstream file(fileName.c_str(), std::ios::binary);
+        image.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    const size_t size = graph.size();
+    const size_t upOffsets = 2 * sizeof(uint64_t) + sizeof(uint64_t) + size * sizeof(int) + sizeof(uint64_t);
+    const size_t upArcs = upOffsets + (size + 1) * sizeof(uint32_t) + sizeof(uint64_t);
+
+    int32_t firstTarget = -1;
+    std::memcpy(&firstTarget, &image[upArcs + offsetof(HierarchyArc, to)], sizeof(firstTarget));
+    CPPUNIT_ASSERT_EQUAL(built.upBegin(0)->to, firstTarget);
+
+    auto corrupt = [&](size_t offset, int32_t value)
+    {
+        std::string patched = image;
+        std::memcpy(&patched[offset], &value, sizeof(value));
+        std::ofstream file(fileName.c_str(), std::ios::binary | std::ios::trunc);
+        file.write(patched.data(), patched.size());
+    };
+
+    corrupt(upOffsets + size * sizeof(uint32_t), 1 << 20);
+    CPPUNIT_ASSERT_THROW(loaded.load(fileName), std::runtime_error);
+    corrupt(upOffsets + sizeof(uint32_t), 1 << 20);
+    CPPUNIT_ASSERT_THROW(loaded.load(fileName), std::runtime_error);
+    corrupt(upArcs + offsetof(HierarchyArc, to), size);
+    CPPUNIT_ASSERT_THROW(loaded.load(fileName), std::runtime_error);
+    corrupt(upArcs + offsetof(HierarchyArc, middle), -7);
+    CPPUNIT_ASSERT_THROW(loaded.load(fileName), std::runtime_error);
+    std::remove(fileName.c_str());
+}
+
+int main()
+{
+    CppUnit::TextUi::TestRunner runner;
+    CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+    runner.addTest( registry.makeTest() );
+    runner.run();
+    return 0;
+}
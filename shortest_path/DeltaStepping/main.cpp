@@ -0,0 +1,558 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <assert.h>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+
+using namespace std;
+
+typedef unsigned int uint;
+
+class Edge
+{
+    int m_from, m_to;
+    float m_weight;
+public:
+    Edge(int from, int to, float weight)
+        : m_from(from), m_to(to), m_weight(weight)
+    { }
+
+    Edge(char from, char to, float weight)
+        : m_from(from - 'A'), m_to(to - 'A'), m_weight(weight)
+    { }
+
+    int from() const { return m_from; }
+    int to() const { return m_to; }
+    float weight() const { return m_weight; }
+};
+
+
+class Graph
+{
+    std::vector< std::vector<Edge> > m_edges;
+public:
+    Graph(int size)
+        : m_edges(size)
+    { }
+
+    size_t size() const { return m_edges.size(); }
+
+    void add(const Edge& e) { m_edges[e.from()].push_back(e); }
+    void add(int from, int to, float weight)
+    { 
+        Edge e(from, to, weight);
+        add(e);
+    }
+
+    void add(char from, char to, float weight)
+    { 
+        Edge e(from, to, weight);
+        add(e);
+    }
+
+    const std::vector<Edge>& connected(int vertex) const 
+    {
+        return m_edges[vertex];
+    }
+};
+
+struct Result
+{
+    int from;
+    int path;
+};
+
+// Rebuilds the 'from' pointers from converged distances so that they do
+// not depend on the relaxation order: a BFS from the source over tight
+// edges (path[u] + weight == path[v]) gives every vertex the smallest tight
+// predecessor among those one hop closer to the source.
+void canonicalParents(const Graph& graph, int source, std::vector<Result>& result)
+{
+    std::vector<int> hops(graph.size(), -1);
+    std::vector<int> level(1, source);
+    std::vector<int> nextLevel;
+
+    hops[source] = 0;
+    result[source].from = source;
+
+    for (int hop = 1; !level.empty(); ++hop)
+    {
+        std::sort(level.begin(), level.end());
+        nextLevel.clear();
+
+        for (int vertex: level)
+        {
+            for (const Edge& edge: graph.connected(vertex))
+            {
+                int next = edge.to();
+                if (hops[next] == -1 && static_cast<int>(result[vertex].path + edge.weight()) == result[next].path)
+                {
+                    hops[next] = hop;
+                    result[next].from = vertex;
+                    nextLevel.push_back(next);
+                }
+            }
+        }
+
+        level.swap(nextLevel);
+    }
+}
+
+// (path, from) packed into one word whose integer order is the order of
+// the path, then of the parent; relaxations settle on it with atomic min
+inline uint64_t packResult(int path, int from)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(path) ^ 0x80000000u) << 32) | static_cast<uint32_t>(from);
+}
+
+inline int packedPath(uint64_t packed)
+{
+    return static_cast<int>(static_cast<uint32_t>(packed >> 32) ^ 0x80000000u);
+}
+
+inline int packedFrom(uint64_t packed)
+{
+    return static_cast<int>(static_cast<uint32_t>(packed));
+}
+
+// atomic fetch-min; returns whether 'value' was stored
+bool atomicMin(std::atomic<uint64_t>& target, uint64_t value)
+{
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value < current)
+    {
+        if (target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Delta-stepping single-source shortest paths for non-negative weights.
+// Vertices sit in buckets of width 'delta' by tentative distance. The
+// lowest non-empty bucket is settled by repeatedly relaxing the light
+// edges of its vertices, which may refill it; the heavy edges of
+// everything it settled are relaxed once afterwards. Paths are integers,
+// so an edge adds its truncated weight and is light when that is <= delta:
+// only then is a heavy edge sure to land in a later bucket. Relaxations
+// within a phase run in parallel through atomic min on packed (path, from)
+// words. The result has the shape and contents BellmanFord returns.
+class DeltaStepping
+{
+public:
+    DeltaStepping(const Graph& graph, float delta, uint threadCount = 0)
+        : m_Graph(graph)
+        , m_Delta(delta)
+        , m_ThreadCount(threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency()))
+        , m_Light(graph.size())
+        , m_Heavy(graph.size())
+        , m_Packed(graph.size())
+        , m_Changed((graph.size() + 63) / 64)
+    {
+        assert(delta > 0);
+
+        for (uint v = 0; v < graph.size(); ++v)
+        {
+            for (const Edge& edge: graph.connected(v))
+            {
+                assert(edge.weight() >= 0);
+                (static_cast<int>(edge.weight()) <= delta ? m_Light : m_Heavy)[v].push_back(edge);
+            }
+        }
+    }
+
+    std::vector<Result> run(int source)
+    {
+        for (std::atomic<uint64_t>& packed: m_Packed)
+        {
+            packed.store(packResult(999999, -1), std::memory_order_relaxed);
+        }
+        m_Packed[source].store(packResult(0, source), std::memory_order_relaxed);
+
+        m_Buckets.assign(1, std::vector<int>(1, source));
+
+        std::vector<int> frontier;
+        std::vector<int> settled;
+        std::vector<bool> inSettled(m_Graph.size(), false);
+
+        for (size_t current = 0; current < m_Buckets.size(); ++current)
+        {
+            settled.clear();
+
+            while (!m_Buckets[current].empty())
+            {
+                // drop vertices that moved to a lower distance since they were bucketed
+                frontier.clear();
+                for (int vertex: m_Buckets[current])
+                {
+                    if (bucketOf(path(vertex)) == current)
+                    {
+                        frontier.push_back(vertex);
+                        if (!inSettled[vertex])
+                        {
+                            inSettled[vertex] = true;
+                            settled.push_back(vertex);
+                        }
+                    }
+                }
+                m_Buckets[current].clear();
+
+                std::sort(frontier.begin(), frontier.end());
+                frontier.erase(std::unique(frontier.begin(), frontier.end()), frontier.end());
+
+                relaxAll(frontier, m_Light);
+            }
+
+            relaxAll(settled, m_Heavy);
+
+            for (int vertex: settled)
+            {
+                inSettled[vertex] = false;
+            }
+        }
+
+        std::vector<Result> result(m_Graph.size());
+        for (uint v = 0; v < m_Graph.size(); ++v)
+        {
+            uint64_t packed = m_Packed[v].load(std::memory_order_relaxed);
+            result[v] = {packedFrom(packed), packedPath(packed)};
+        }
+
+        canonicalParents(m_Graph, source, result);
+        return result;
+    }
+
+private:
+    int path(int vertex) const
+    {
+        return packedPath(m_Packed[vertex].load(std::memory_order_relaxed));
+    }
+
+    size_t bucketOf(int path) const
+    {
+        return static_cast<size_t>(path / m_Delta);
+    }
+
+    // relaxes 'edges' of every vertex in 'vertice' across threads, then
+    // files the improved vertices into their buckets
+    void relaxAll(const std::vector<int>& vertice, const std::vector<std::vector<Edge>>& edges)
+    {
+        size_t work = 0;
+        for (int vertex: vertice)
+        {
+            work += edges[vertex].size();
+        }
+        const uint threads = std::max<size_t>(1, std::min<size_t>(m_ThreadCount, work / 1024));
+
+        std::vector<std::vector<int>> improved(threads);
+
+        auto relaxRange = [&](uint t, size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                int vertex = vertice[i];
+                int from = path(vertex);
+                for (const Edge& edge: edges[vertex])
+                {
+                    int next = edge.to();
+                    int candidate = from + edge.weight();
+                    if (from + edge.weight() < path(next)
+                        && atomicMin(m_Packed[next], packResult(candidate, vertex)))
+                    {
+                        uint64_t bit = uint64_t(1) << (next % 64);
+                        if (!(m_Changed[next / 64].fetch_or(bit, std::memory_order_relaxed) & bit))
+                        {
+                            improved[t].push_back(next);
+                        }
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        const size_t size = vertice.size();
+        const size_t chunk = (size + threads - 1) / threads;
+        for (uint t = 1; t < threads; ++t)
+        {
+            workers.emplace_back(relaxRange, t, std::min(size, t * chunk), std::min(size, (t + 1) * chunk));
+        }
+        relaxRange(0, 0, std::min(size, chunk));
+        for (std::thread& worker: workers)
+        {
+            worker.join();
+        }
+
+        for (const std::vector<int>& local: improved)
+        {
+            for (int vertex: local)
+            {
+                m_Changed[vertex / 64].store(0, std::memory_order_relaxed);
+
+                size_t bucket = bucketOf(path(vertex));
+                if (bucket >= m_Buckets.size())
+                {
+                    m_Buckets.resize(bucket + 1);
+                }
+                m_Buckets[bucket].push_back(vertex);
+            }
+        }
+    }
+
+    const Graph& m_Graph;
+    float m_Delta;
+    uint m_ThreadCount;
+    std::vector<std::vector<Edge>> m_Light;
+    std::vector<std::vector<Edge>> m_Heavy;
+    std::vector<std::atomic<uint64_t>> m_Packed;
+    std::vector<std::atomic<uint64_t>> m_Changed;
+    std::vector<std::vector<int>> m_Buckets;
+};
+
+std::vector<Result> deltaStepping(const Graph& graph, int source, float delta, uint threadCount = 0)
+{
+    DeltaStepping solver(graph, delta, threadCount);
+    return solver.run(source);
+}
+
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+bool operator==(const Result& res1, const Result& res2)
+{
+    return res1.from == res2.from && res1.path == res2.path;
+}
+
+std::ostream& operator<<(std::ostream& os, const Result& edge)
+{
+    char letter[] = "A";
+    letter[0] += edge.from;
+    os << "{from: " << letter << ", path: " << edge.path << '}';
+    return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const std::vector<Result>& v)
+{
+    os << '[';
+
+    if (!v.empty())
+    {
+        os << v[0];
+
+        for (auto it = v.begin()+1; it != v.end(); ++it)
+        {
+            os << ", " << *it;
+        }
+    }
+    os << ']';
+    return os;
+}
+
+
+class Test: public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE( Test ); 
+
+    CPPUNIT_TEST( test1 );
+    CPPUNIT_TEST( test2 );
+    CPPUNIT_TEST( test3 );
+    CPPUNIT_TEST( test4 );
+    CPPUNIT_TEST( test5 );
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void test1();
+    void test2();
+    void test3();
+    void test4();
+    void test5();
+};
+CPPUNIT_TEST_SUITE_REGISTRATION( Test );
+
+// reference distances: O(V^2) Dijkstra
+std::vector<int> referencePaths(const Graph& graph, int source)
+{
+    std::vector<int> path(graph.size(), 999999);
+    std::vector<bool> done(graph.size(), false);
+    path[source] = 0;
+
+    for (uint round = 0; round < graph.size(); ++round)
+    {
+        int vertex = -1;
+        for (uint v = 0; v < graph.size(); ++v)
+        {
+            if (!done[v] && (vertex == -1 || path[v] < path[vertex]))
+            {
+                vertex = v;
+            }
+        }
+        done[vertex] = true;
+
+        for (const Edge& edge: graph.connected(vertex))
+        {
+            if (path[vertex] + edge.weight() < path[edge.to()])
+            {
+                path[edge.to()] = path[vertex] + edge.weight();
+            }
+        }
+    }
+
+    return path;
+}
+
+void Test::test1()
+{
+
+    Graph graph(8);
+
+    graph.add(0, 1, 5);
+    graph.add(0, 4, 9);
+    graph.add(0, 7, 8);
+
+    graph.add(1, 2, 12);
+    graph.add(1, 3, 15);
+    graph.add(1, 7, 4);
+
+    graph.add(2, 3, 3);
+    graph.add(2, 6, 11);
+
+    graph.add(3, 6, 9);
+
+    graph.add(4, 5, 4);
+    graph.add(4, 6, 20);
+    graph.add(4, 7, 5);
+
+    graph.add(5, 2, 1);
+    graph.add(5, 6, 13);
+
+    graph.add(7, 2, 7);
+    graph.add(7, 5, 6);
+
+    std::vector<Result> expect = {{0, 0}, {0, 5}, {5, 14}, {2, 17}, {0, 9}, {4, 13}, {2, 25}, {0, 8}};
+
+    CPPUNIT_ASSERT_EQUAL(expect, deltaStepping(graph, 0, 3));
+    CPPUNIT_ASSERT_EQUAL(expect, deltaStepping(graph, 0, 1));
+    CPPUNIT_ASSERT_EQUAL(expect, deltaStepping(graph, 0, 100));
+}
+
+void Test::test2()
+{
+    // E is not reachable, D -> B closes a zero-weight cycle
+    Graph graph(5);
+
+    graph.add('A', 'B', 2);
+    graph.add('B', 'C', 0);
+    graph.add('C', 'D', 1);
+    graph.add('D', 'C', 0);
+    graph.add('E', 'A', 1);
+
+    std::vector<Result> expect = {{0, 0}, {0, 2}, {1, 2}, {2, 3}, {-1, 999999}};
+
+    CPPUNIT_ASSERT_EQUAL(expect, deltaStepping(graph, 0, 1));
+}
+
+void Test::test3()
+{
+    const int size = 5000;
+    Graph graph(size);
+
+    uint32_t seed = 21;
+    for (int i = 0; i < size * 6; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        int from = (seed >> 8) % size;
+        seed = seed * 1103515245 + 12345;
+        int to = (seed >> 8) % size;
+        seed = seed * 1103515245 + 12345;
+        graph.add(from, to, float((seed >> 8) % 100));
+    }
+
+    std::vector<int> expect = referencePaths(graph, 0);
+
+    for (float delta: {1.0f, 10.0f, 50.0f, 1000.0f})
+    {
+        std::vector<Result> result = deltaStepping(graph, 0, delta, 4);
+        for (int v = 0; v < size; ++v)
+        {
+            CPPUNIT_ASSERT_EQUAL(expect[v], result[v].path);
+        }
+
+        CPPUNIT_ASSERT(result == deltaStepping(graph, 0, delta, 1));
+    }
+}
+
+void Test::test4()
+{
+    // solver reuse: the light/heavy split is done once
+    Graph graph(4);
+
+    graph.add(0, 1, 1);
+    graph.add(1, 2, 7);
+    graph.add(0, 2, 9);
+    graph.add(2, 3, 1);
+    graph.add(3, 0, 2);
+
+    DeltaStepping solver(graph, 2);
+
+    std::vector<Result> expect = {{0, 0}, {0, 1}, {1, 8}, {2, 9}};
+    CPPUNIT_ASSERT_EQUAL(expect, solver.run(0));
+
+    expect = {{3, 3}, {0, 4}, {2, 0}, {2, 1}};
+    CPPUNIT_ASSERT_EQUAL(expect, solver.run(2));
+}
+
+void Test::test5()
+{
+    // fractional weights and delta: 0 -> 1 weighs 1.7 > delta but adds 1,
+    // landing in the bucket being settled
+    Graph graph(3);
+
+    graph.add(0, 1, 1.7f);
+    graph.add(1, 2, 1.0f);
+
+    std::vector<Result> expect = {{0, 0}, {0, 1}, {1, 2}};
+    for (float delta: {0.5f, 1.5f, 100.0f})
+    {
+        CPPUNIT_ASSERT_EQUAL(expect, deltaStepping(graph, 0, delta, 1));
+    }
+
+    const int size = 2000;
+    Graph random(size);
+
+    uint32_t seed = 5;
+    for (int i = 0; i < size * 4; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        int from = (seed >> 8) % size;
+        seed = seed * 1103515245 + 12345;
+        int to = (seed >> 8) % size;
+        seed = seed * 1103515245 + 12345;
+        random.add(from, to, ((seed >> 8) % 400) / 8.0f);
+    }
+
+    std::vector<int> paths = referencePaths(random, 0);
+    for (float delta: {0.75f, 2.5f, 12.25f})
+    {
+        std::vector<Result> result = deltaStepping(random, 0, delta, 4);
+        for (int v = 0; v < size; ++v)
+        {
+            CPPUNIT_ASSERT_EQUAL(paths[v], result[v].path);
+        }
+    }
+}
+
+int main()
+{
+    CppUnit::TextUi::TestRunner runner;
+    CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+    runner.addTest( registry.makeTest() );
+    runner.run();
+    return 0;
+}
@@ -0,0 +1,324 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <assert.h>
+#include <cstdint>
+
+#include "../../common/DijkstraContext.h"
+#include "../../common/BucketQueue.h"
+
+using namespace std;
+
+typedef unsigned int uint;
+
+class Edge
+{
+    int m_from, m_to;
+    float m_weight;
+public:
+    Edge(int from, int to, float weight)
+        : m_from(from), m_to(to), m_weight(weight)
+    { }
+
+    Edge(char from, char to, float weight)
+        : m_from(from - 'A'), m_to(to - 'A'), m_weight(weight)
+    { }
+
+    int from() const { return m_from; }
+    int to() const { return m_to; }
+    float weight() const { return m_weight; }
+};
+
+
+class Graph
+{
+    std::vector< std::vector<Edge> > m_edges;
+public:
+    Graph(int size)
+        : m_edges(size)
+    { }
+
+    size_t size() const { return m_edges.size(); }
+
+    void add(const Edge& e) { m_edges[e.from()].push_back(e); }
+    void add(int from, int to, float weight)
+    { 
+        Edge e(from, to, weight);
+        add(e);
+    }
+
+    void add(char from, char to, float weight)
+    { 
+        Edge e(from, to, weight);
+        add(e);
+    }
+
+    const std::vector<Edge>& connected(int vertex) const 
+    {
+        return m_edges[vertex];
+    }
+};
+
+struct Result
+{
+    int from;
+    int path;
+};
+
+std::vector<Result> Dijkstra(const Graph& graph, int source)
+{
+    DijkstraContext<Result> context(graph.size());
+    return Dijkstra(graph, source, context);
+}
+
+struct QueuedVertexPath
+{
+    uint32_t operator()(const QueuedVertex& queued) const
+    {
+        return queued.path;
+    }
+};
+
+// Dijkstra on the monotone radix heap: settled paths never decrease, so
+// pushes are O(1) and pops compare no items. There is no decrease-key; an
+// improved vertex is pushed again and its stale entries are skipped once
+// the vertex is settled. Paths match Dijkstra(); among equal paths the
+// chosen predecessor may differ.
+std::vector<Result> RadixDijkstra(const Graph& graph, int source)
+{
+    std::vector<Result> result(graph.size(), {-1, 999999});
+    std::vector<bool> done(graph.size(), false);
+    RadixHeap<QueuedVertex, QueuedVertexPath> heap;
+
+    result[source] = {source, 0};
+    heap.push({source, 0});
+
+    while (!heap.empty())
+    {
+        int vertex = heap.pop().vertex;
+        if (done[vertex])
+        {
+            continue;
+        }
+        done[vertex] = true;
+
+        for (const Edge& edge: graph.connected(vertex))
+        {
+            assert(edge.weight() >= 0);
+
+            int next = edge.to();
+            if (!done[next] && result[vertex].path + edge.weight() < result[next].path)
+            {
+                result[next].path = result[vertex].path + edge.weight();
+                result[next].from = vertex;
+                heap.push({next, result[next].path});
+            }
+        }
+    }
+
+    return result;
+}
+
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+bool operator==(const Result& res1, const Result& res2)
+{
+    return res1.from == res2.from && res1.path == res2.path;
+}
+
+std::ostream& operator<<(std::ostream& os, const Result& edge)
+{
+    char letter[] = "A";
+    letter[0] += edge.from;
+    os << "{from: " << letter << ", path: " << edge.path << '}';
+    return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const std::vector<Result>& v)
+{
+    os << '[';
+
+    if (!v.empty())
+    {
+        os << v[0];
+
+        for (auto it = v.begin()+1; it != v.end(); ++it)
+        {
+            os << ", " << *it;
+        }
+    }
+    os << ']';
+    return os;
+}
+
+
+class Test: public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE( Test ); 
+
+    CPPUNIT_TEST( test1 );
+    CPPUNIT_TEST( test2 );
+    CPPUNIT_TEST( test3 );
+    CPPUNIT_TEST( test4 );
+    CPPUNIT_TEST( test5 );
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void test1();
+    void test2();
+    void test3();
+    void test4();
+    void test5();
+};
+CPPUNIT_TEST_SUITE_REGISTRATION( Test );
+
+Graph testGraph()
+{
+    Graph graph(8);
+
+    graph.add(0, 1, 5);
+    graph.add(0, 4, 9);
+    graph.add(0, 7, 8);
+
+    graph.add(1, 2, 12);
+    graph.add(1, 3, 15);
+    graph.add(1, 7, 4);
+
+    graph.add(2, 3, 3);
+    graph.add(2, 6, 11);
+
+    graph.add(3, 6, 9);
+
+    graph.add(4, 5, 4);
+    graph.add(4, 6, 20);
+    graph.add(4, 7, 5);
+
+    graph.add(5, 2, 1);
+    graph.add(5, 6, 13);
+
+    graph.add(7, 2, 7);
+    graph.add(7, 5, 6);
+
+    return graph;
+}
+
+void Test::test1()
+{
+    std::vector<Result> expect = {{0, 0}, {0, 5}, {5, 14}, {2, 17}, {0, 9}, {4, 13}, {2, 25}, {0, 8}};
+
+    CPPUNIT_ASSERT_EQUAL(expect, Dijkstra(testGraph(), 0));
+}
+
+void Test::test2()
+{
+    Graph graph = testGraph();
+    DijkstraContext<Result> context(graph.size());
+
+    // 3 is settled after 0, 1, 7, 4, 5, 2
+    const std::vector<Result>& result = Dijkstra(graph, 0, context, 3);
+
+    Result expect = {2, 17};
+    CPPUNIT_ASSERT_EQUAL(expect, result[3]);
+    expect = {5, 14};
+    CPPUNIT_ASSERT_EQUAL(expect, result[2]);
+}
+
+void Test::test3()
+{
+    // one context, many queries: every answer matches a fresh search
+    Graph graph = testGraph();
+    DijkstraContext<Result> context(graph.size());
+
+    for (int round = 0; round < 3; ++round)
+    {
+        for (int source = 0; source < 8; ++source)
+        {
+            for (int target = 0; target < 8; ++target)
+            {
+                std::vector<Result> fresh = Dijkstra(graph, source);
+                const std::vector<Result>& reused = Dijkstra(graph, source, context, target);
+                CPPUNIT_ASSERT_EQUAL(fresh[target], reused[target]);
+            }
+
+            CPPUNIT_ASSERT_EQUAL(Dijkstra(graph, source), Dijkstra(graph, source, context));
+        }
+    }
+}
+
+void Test::test4()
+{
+    // E cannot be reached; queries after it still start clean
+    Graph graph(5);
+
+    graph.add('A', 'B', 1);
+    graph.add('B', 'C', 3);
+    graph.add('A', 'C', 5);
+    graph.add('C', 'D', 0);
+    graph.add('E', 'A', 2);
+
+    DijkstraContext<Result> context(graph.size());
+
+    std::vector<Result> expect = {{0, 0}, {0, 1}, {1, 4}, {2, 4}, {-1, 999999}};
+    CPPUNIT_ASSERT_EQUAL(expect, Dijkstra(graph, 0, context));
+
+    expect = {{-1, 999999}, {-1, 999999}, {2, 0}, {2, 0}, {-1, 999999}};
+    CPPUNIT_ASSERT_EQUAL(expect, Dijkstra(graph, 2, context));
+
+    expect = {{4, 2}, {0, 3}, {1, 6}, {2, 6}, {4, 0}};
+    CPPUNIT_ASSERT_EQUAL(expect, Dijkstra(graph, 4, context));
+}
+
+void Test::test5()
+{
+    std::vector<Result> expect = {{0, 0}, {0, 5}, {5, 14}, {2, 17}, {0, 9}, {4, 13}, {2, 25}, {0, 8}};
+    CPPUNIT_ASSERT_EQUAL(expect, RadixDijkstra(testGraph(), 0));
+
+    // random graphs with small integer weights: same paths as the d-ary heap
+    uint32_t seed = 7;
+    for (int round = 0; round < 5; ++round)
+    {
+        const int size = 500;
+        Graph graph(size);
+        for (int edge = 0; edge < size * 6; ++edge)
+        {
+            seed = seed * 1103515245 + 12345;
+            int from = (seed >> 8) % size;
+            seed = seed * 1103515245 + 12345;
+            int to = (seed >> 8) % size;
+            seed = seed * 1103515245 + 12345;
+            graph.add(from, to, (seed >> 8) % (round == 0 ? 2 : 1000));
+        }
+
+        std::vector<Result> heap = Dijkstra(graph, 0);
+        std::vector<Result> radix = RadixDijkstra(graph, 0);
+        for (int vertex = 0; vertex < size; ++vertex)
+        {
+            CPPUNIT_ASSERT_EQUAL(heap[vertex].path, radix[vertex].path);
+            if (vertex != 0 && radix[vertex].from != -1)
+            {
+                // the predecessor is reached over an edge that is tight
+                bool tight = false;
+                for (const Edge& edge: graph.connected(radix[vertex].from))
+                {
+                    tight |= edge.to() == vertex && radix[edge.from()].path + edge.weight() == radix[vertex].path;
+                }
+                CPPUNIT_ASSERT(tight);
+            }
+        }
+    }
+}
+
+int main()
+{
+    CppUnit::TextUi::TestRunner runner;
+    CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+    runner.addTest( registry.makeTest() );
+    runner.run();
+    return 0;
+}
@@ -0,0 +1,503 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <assert.h>
+#include <atomic>
+#include <thread>
+#include <cmath>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+typedef unsigned int uint;
+
+class Edge
+{
+    int m_from, m_to;
+    float m_weight;
+public:
+    Edge(int from, int to, float weight)
+        : m_from(from), m_to(to), m_weight(weight)
+    { }
+
+    Edge(char from, char to, float weight)
+        : m_from(from - 'A'), m_to(to - 'A'), m_weight(weight)
+    { }
+
+    int from() const { return m_from; }
+    int to() const { return m_to; }
+    float weight() const { return m_weight; }
+};
+
+
+class Graph
+{
+    std::vector< std::vector<Edge> > m_edges;
+public:
+    Graph(int size)
+        : m_edges(size)
+    { }
+
+    size_t size() const { return m_edges.size(); }
+
+    void add(const Edge& e) { m_edges[e.from()].push_back(e); }
+    void add(int from, int to, float weight)
+    { 
+        Edge e(from, to, weight);
+        add(e);
+    }
+
+    void add(char from, char to, float weight)
+    { 
+        Edge e(from, to, weight);
+        add(e);
+    }
+
+    const std::vector<Edge>& connected(int vertex) const 
+    {
+        return m_edges[vertex];
+    }
+};
+
+// All-pairs distances and, optionally, predecessors in flat row-major
+// matrices. The row stride is padded to whole tiles; padding vertices
+// have no edges. predecessor(i, j) is the vertex before j on the path
+// from i, -1 if j cannot be reached.
+struct AllPairs
+{
+    static const int TILE = 64;
+
+    size_t size = 0;
+    size_t stride = 0;
+    std::vector<float> distances;
+    std::vector<int> predecessors;
+
+    float distance(int from, int to) const { return distances[from * stride + to]; }
+    int predecessor(int from, int to) const { return predecessors[from * stride + to]; }
+
+    // vertices of the shortest path from 'from' to 'to', both included;
+    // empty when 'to' cannot be reached or predecessors were not tracked
+    std::vector<int> path(int from, int to) const
+    {
+        std::vector<int> vertice;
+        if (predecessors.empty() || predecessor(from, to) == -1)
+        {
+            return vertice;
+        }
+
+        for (int vertex = to; vertex != from; vertex = predecessor(from, vertex))
+        {
+            vertice.push_back(vertex);
+        }
+        vertice.push_back(from);
+        std::reverse(vertice.begin(), vertice.end());
+        return vertice;
+    }
+};
+
+const int AllPairs::TILE;
+
+// row[j] = min(row[j], through + kRow[j]) over one tile width.
+void minPlusRow(float* row, const float* kRow, float through)
+{
+    int j = 0;
+
+#if defined(__AVX512F__)
+    const __m512 vThrough = _mm512_set1_ps(through);
+    for (; j + 16 <= AllPairs::TILE; j += 16)
+    {
+        __m512 candidate = _mm512_add_ps(vThrough, _mm512_loadu_ps(kRow + j));
+        _mm512_storeu_ps(row + j, _mm512_min_ps(_mm512_loadu_ps(row + j), candidate));
+    }
+#elif defined(__AVX2__)
+    const __m256 vThrough = _mm256_set1_ps(through);
+    for (; j + 8 <= AllPairs::TILE; j += 8)
+    {
+        __m256 candidate = _mm256_add_ps(vThrough, _mm256_loadu_ps(kRow + j));
+        _mm256_storeu_ps(row + j, _mm256_min_ps(_mm256_loadu_ps(row + j), candidate));
+    }
+#endif
+
+    for (; j < AllPairs::TILE; ++j)
+    {
+        row[j] = std::min(row[j], through + kRow[j]);
+    }
+}
+
+// Relaxes tile (tileRow, tileColumn) through the vertices of tile 'pivot'.
+// The k loop is outermost, so the pivot tiles may be updated in place.
+void relaxTile(AllPairs& result, size_t tileRow, size_t tileColumn, size_t pivot)
+{
+    const size_t stride = result.stride;
+    const size_t column = tileColumn * AllPairs::TILE;
+    float* distances = result.distances.data();
+
+    for (size_t k = pivot * AllPairs::TILE; k < (pivot + 1) * AllPairs::TILE; ++k)
+    {
+        const float* kRow = distances + k * stride + column;
+
+        for (size_t i = tileRow * AllPairs::TILE; i < (tileRow + 1) * AllPairs::TILE; ++i)
+        {
+            float through = distances[i * stride + k];
+            if (through != INFINITY)
+            {
+                minPlusRow(distances + i * stride + column, kRow, through);
+            }
+        }
+    }
+}
+
+// Runs fn(0 .. count - 1) on up to 'threadCount' threads.
+template <class Function>
+void parallelFor(size_t count, uint threadCount, Function fn)
+{
+    std::atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        for (size_t index; (index = next++) < count; )
+        {
+            fn(index);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (uint t = 1; t < std::min<size_t>(threadCount, count); ++t)
+    {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread: workers)
+    {
+        thread.join();
+    }
+}
+
+void tiledFloydWarshall(AllPairs& result, uint threadCount)
+{
+    const size_t tiles = result.stride / AllPairs::TILE;
+
+    for (size_t pivot = 0; pivot < tiles; ++pivot)
+    {
+        // the pivot tile depends only on itself
+        relaxTile(result, pivot, pivot, pivot);
+
+        // tiles in the pivot row and column depend on the pivot tile
+        parallelFor(2 * (tiles - 1), threadCount, [&](size_t index)
+        {
+            size_t other = index / 2 < pivot ? index / 2 : index / 2 + 1;
+            if (index % 2)
+            {
+                relaxTile(result, other, pivot, pivot);
+            }
+            else
+            {
+                relaxTile(result, pivot, other, pivot);
+            }
+        });
+
+        // the rest depend on the pivot row and column only
+        parallelFor(tiles * tiles, threadCount, [&](size_t index)
+        {
+            size_t tileRow = index / tiles;
+            size_t tileColumn = index % tiles;
+            if (tileRow != pivot && tileColumn != pivot)
+            {
+                relaxTile(result, tileRow, tileColumn, pivot);
+            }
+        });
+    }
+}
+
+// Fills the predecessor row of 'source' from its converged distances: a
+// BFS over tight edges gives every vertex the smallest tight predecessor
+// among those one hop closer to the source. Carrying predecessors through
+// the tiles instead can close loops on zero-weight cycles, as the tiles
+// see the pivots in a different order than the textbook triple loop.
+void tightPredecessors(const Graph& graph, AllPairs& result, int source)
+{
+    const float* distance = &result.distances[source * result.stride];
+    int* predecessor = &result.predecessors[source * result.stride];
+
+    std::vector<int> level(1, source);
+    std::vector<int> nextLevel;
+    predecessor[source] = source;
+
+    while (!level.empty())
+    {
+        std::sort(level.begin(), level.end());
+        nextLevel.clear();
+
+        for (int vertex: level)
+        {
+            for (const Edge& edge: graph.connected(vertex))
+            {
+                int next = edge.to();
+                float slack = distance[vertex] + edge.weight() - distance[next];
+                if (predecessor[next] == -1 && std::abs(slack) <= 1e-5f * std::max(1.0f, std::abs(distance[next])))
+                {
+                    predecessor[next] = vertex;
+                    nextLevel.push_back(next);
+                }
+            }
+        }
+
+        level.swap(nextLevel);
+    }
+}
+
+// Blocked Floyd-Warshall on 64x64 float tiles: three tiles (48KB) fit in
+// L2, and a tile row (256B) streams through L1 in the min-plus kernel.
+// Each pivot step relaxes the pivot tile, then its row and column, then
+// all remaining tiles, the last two phases spread over 'threadCount'
+// threads. Predecessors, when asked for, are derived afterwards, one row
+// per task. Returns false if the graph has a negative cycle; 'result' then
+// holds no meaningful distances.
+bool FloydWarshall(const Graph& graph, AllPairs& result, bool predecessors = false, uint threadCount = 0)
+{
+    const size_t size = graph.size();
+    const size_t stride = (size + AllPairs::TILE - 1) / AllPairs::TILE * AllPairs::TILE;
+
+    result.size = size;
+    result.stride = stride;
+    result.distances.assign(stride * stride, INFINITY);
+    result.predecessors.assign(predecessors ? stride * stride : 0, -1);
+
+    for (size_t vertex = 0; vertex < size; ++vertex)
+    {
+        result.distances[vertex * stride + vertex] = 0;
+
+        for (const Edge& edge: graph.connected(vertex))
+        {
+            float& distance = result.distances[vertex * stride + edge.to()];
+            distance = std::min(distance, edge.weight());
+        }
+    }
+
+    if (!threadCount)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    tiledFloydWarshall(result, threadCount);
+
+    for (size_t vertex = 0; vertex < size; ++vertex)
+    {
+        if (result.distance(vertex, vertex) < 0)
+        {
+            return false;
+        }
+    }
+
+    if (predecessors)
+    {
+        parallelFor(size, threadCount, [&](size_t source)
+        {
+            tightPredecessors(graph, result, source);
+        });
+    }
+    return true;
+}
+
+
+std::ostream& operator<<(std::ostream& os, const std::vector<int>& v)
+{
+    os << '[';
+
+    if (!v.empty())
+    {
+        os << v[0];
+
+        for (auto it = v.begin()+1; it != v.end(); ++it)
+        {
+            os << ", " << *it;
+        }
+    }
+    os << ']';
+    return os;
+}
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test: public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE( Test ); 
+
+    CPPUNIT_TEST( test1 );
+    CPPUNIT_TEST( test2 );
+    CPPUNIT_TEST( test3 );
+    CPPUNIT_TEST( test4 );
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void test1();
+    void test2();
+    void test3();
+    void test4();
+};
+CPPUNIT_TEST_SUITE_REGISTRATION( Test );
+
+void Test::test1()
+{
+    Graph graph(5);
+
+    graph.add('A', 'B', 3);
+    graph.add('A', 'C', 8);
+    graph.add('A', 'E', -4);
+    graph.add('B', 'D', 1);
+    graph.add('B', 'E', 7);
+    graph.add('C', 'B', 4);
+    graph.add('D', 'A', 2);
+    graph.add('D', 'C', -5);
+    graph.add('E', 'D', 6);
+
+    AllPairs result;
+    CPPUNIT_ASSERT(FloydWarshall(graph, result, true));
+
+    std::vector<std::vector<float>> expect = {
+        { 0,  1, -3,  2, -4},
+        { 3,  0, -4,  1, -1},
+        { 7,  4,  0,  5,  3},
+        { 2, -1, -5,  0, -2},
+        { 8,  5,  1,  6,  0}};
+
+    for (int from = 0; from < 5; ++from)
+    {
+        for (int to = 0; to < 5; ++to)
+        {
+            CPPUNIT_ASSERT_EQUAL(expect[from][to], result.distance(from, to));
+        }
+    }
+
+    std::vector<int> path = {0, 4, 3, 2, 1};
+    CPPUNIT_ASSERT_EQUAL(path, result.path(0, 1));
+    path = {2, 1, 3, 0};
+    CPPUNIT_ASSERT_EQUAL(path, result.path(2, 0));
+    path = {3};
+    CPPUNIT_ASSERT_EQUAL(path, result.path(3, 3));
+}
+
+void Test::test2()
+{
+    // B -> C -> D -> B weighs -1
+    Graph graph(4);
+
+    graph.add('A', 'B', 1);
+    graph.add('B', 'C', 2);
+    graph.add('C', 'D', -4);
+    graph.add('D', 'B', 1);
+
+    AllPairs result;
+    CPPUNIT_ASSERT(!FloydWarshall(graph, result));
+}
+
+void Test::test3()
+{
+    // D cannot be reached; without predecessors there are no paths
+    Graph graph(4);
+
+    graph.add('A', 'B', 2);
+    graph.add('B', 'C', -1);
+    graph.add('D', 'A', 1);
+
+    AllPairs result;
+    CPPUNIT_ASSERT(FloydWarshall(graph, result));
+    CPPUNIT_ASSERT_EQUAL(1.0f, result.distance(0, 2));
+    CPPUNIT_ASSERT_EQUAL(2.0f, result.distance(3, 2));
+    CPPUNIT_ASSERT_EQUAL(float(INFINITY), result.distance(0, 3));
+    CPPUNIT_ASSERT(result.path(0, 2).empty());
+
+    CPPUNIT_ASSERT(FloydWarshall(graph, result, true));
+    CPPUNIT_ASSERT(result.path(0, 3).empty());
+    std::vector<int> path = {3, 0, 1, 2};
+    CPPUNIT_ASSERT_EQUAL(path, result.path(3, 2));
+}
+
+void Test::test4()
+{
+    // several tiles, negative edges without negative cycles: compared with
+    // the textbook triple loop, and every path adds up to its distance
+    const int size = 150;
+    Graph graph(size);
+
+    std::vector<int> p(size);
+    for (int vertex = 0; vertex < size; ++vertex)
+    {
+        p[vertex] = (vertex * 37) % 23;
+    }
+    for (int vertex = 0; vertex < size; ++vertex)
+    {
+        for (int k = 1; k <= 5; ++k)
+        {
+            int next = (vertex * 11 + k * 17) % size;
+            graph.add(vertex, next, (vertex * k) % 9 + p[vertex] - p[next]);
+        }
+    }
+
+    std::vector<float> expect(size * size, INFINITY);
+    for (int vertex = 0; vertex < size; ++vertex)
+    {
+        expect[vertex * size + vertex] = 0;
+        for (const Edge& edge: graph.connected(vertex))
+        {
+            float& distance = expect[vertex * size + edge.to()];
+            distance = std::min(distance, edge.weight());
+        }
+    }
+    for (int k = 0; k < size; ++k)
+        for (int i = 0; i < size; ++i)
+            for (int j = 0; j < size; ++j)
+                expect[i * size + j] = std::min(expect[i * size + j], expect[i * size + k] + expect[k * size + j]);
+
+    for (uint threads: {1u, 4u})
+    {
+        AllPairs result;
+        CPPUNIT_ASSERT(FloydWarshall(graph, result, true, threads));
+
+        for (int from = 0; from < size; ++from)
+        {
+            for (int to = 0; to < size; ++to)
+            {
+                CPPUNIT_ASSERT_EQUAL(expect[from * size + to], result.distance(from, to));
+
+                std::vector<int> path = result.path(from, to);
+                if (result.distance(from, to) == INFINITY)
+                {
+                    CPPUNIT_ASSERT(path.empty());
+                    continue;
+                }
+
+                float length = 0;
+                for (size_t i = 1; i < path.size(); ++i)
+                {
+                    float hop = INFINITY;
+                    for (const Edge& edge: graph.connected(path[i - 1]))
+                    {
+                        if (edge.to() == path[i])
+                        {
+                            hop = std::min(hop, edge.weight());
+                        }
+                    }
+                    length += hop;
+                }
+                CPPUNIT_ASSERT_EQUAL(result.distance(from, to), length);
+            }
+        }
+    }
+}
+
+int main()
+{
+    CppUnit::TextUi::TestRunner runner;
+    CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+    runner.addTest( registry.makeTest() );
+    runner.run();
+    return 0;
+}
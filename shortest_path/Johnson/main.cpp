@@ -0,0 +1,535 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <assert.h>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "../../common/DaryHeap.h"
+
+using namespace std;
+
+typedef unsigned int uint;
+
+class Edge
+{
+    int m_from, m_to;
+    float m_weight;
+public:
+    Edge(int from, int to, float weight)
+        : m_from(from), m_to(to), m_weight(weight)
+    { }
+
+    Edge(char from, char to, float weight)
+        : m_from(from - 'A'), m_to(to - 'A'), m_weight(weight)
+    { }
+
+    int from() const { return m_from; }
+    int to() const { return m_to; }
+    float weight() const { return m_weight; }
+};
+
+
+class Graph
+{
+    std::vector< std::vector<Edge> > m_edges;
+public:
+    Graph(int size)
+        : m_edges(size)
+    { }
+
+    size_t size() const { return m_edges.size(); }
+
+    void add(const Edge& e) { m_edges[e.from()].push_back(e); }
+    void add(int from, int to, float weight)
+    { 
+        Edge e(from, to, weight);
+        add(e);
+    }
+
+    void add(char from, char to, float weight)
+    { 
+        Edge e(from, to, weight);
+        add(e);
+    }
+
+    const std::vector<Edge>& connected(int vertex) const 
+    {
+        return m_edges[vertex];
+    }
+};
+
+struct Result
+{
+    int from;
+    int path;
+};
+
+// Relaxes the out-edges of 'vertex', queueing every vertex it improves.
+void relax(const Graph& graph, int vertex, std::vector<Result>& results,
+           std::deque<int>& verticeToUpdate, std::vector<bool>& queued)
+{
+    for (const Edge& edge: graph.connected(vertex))
+    {
+        int next = edge.to();
+        if (results[vertex].path + edge.weight() < results[next].path)
+        {
+            results[next].path = results[vertex].path + edge.weight();
+            results[next].from = vertex;
+
+            if (!queued[next])
+            {
+                queued[next] = true;
+                verticeToUpdate.push_back(next);
+            }
+        }
+    }
+}
+
+
+std::ostream& operator<<(std::ostream& os, const std::vector<int>& v)
+{
+    os << '[';
+
+    if (!v.empty())
+    {
+        os << v[0];
+
+        for (auto it = v.begin()+1; it != v.end(); ++it)
+        {
+            os << ", " << *it;
+        }
+    }
+    os << ']';
+    return os;
+}
+
+// Queue-based Bellman-Ford (SPFA): only vertices whose distance changed
+// are relaxed again, and the search ends as soon as the worklist drains.
+// A vertex relaxed more than V times lies on or behind a negative cycle;
+// the search then stops and the results are not shortest paths. Returns
+// whether a negative cycle was found.
+bool shortestPaths(const Graph& graph, int source, std::vector<Result>& result)
+{
+    result.assign(graph.size(), {-1, 999999});
+    result[source] = {source, 0};
+
+    std::deque<int> verticeToUpdate;
+    std::vector<bool> queued(graph.size(), false);
+    std::vector<unsigned int> passes(graph.size(), 0);
+
+    verticeToUpdate.push_back(source);
+    queued[source] = true;
+
+    while (!verticeToUpdate.empty())
+    {
+        int vertex = verticeToUpdate.front();
+        verticeToUpdate.pop_front();
+        queued[vertex] = false;
+
+        if (++passes[vertex] > graph.size())
+        {
+            return true;
+        }
+
+        relax(graph, vertex, result, verticeToUpdate, queued);
+    }
+
+    return false;
+}
+
+// Edges in compressed sparse row form: the out-edges of 'vertex' are
+// targets/weights[offsets[vertex] .. offsets[vertex + 1]).
+struct CsrGraph
+{
+    std::vector<uint32_t> offsets;
+    std::vector<int> targets;
+    std::vector<int> weights;
+
+    size_t size() const { return offsets.size() - 1; }
+};
+
+// Allocator handing out storage that starts on a 64-byte cache line;
+// plain new/malloc only guarantee alignof(max_align_t).
+template <typename T>
+struct CacheLineAllocator
+{
+    typedef T value_type;
+    static const size_t ALIGNMENT = 64;
+
+    CacheLineAllocator() = default;
+    template <typename U>
+    CacheLineAllocator(const CacheLineAllocator<U>&) {}
+
+    T* allocate(size_t count)
+    {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, ALIGNMENT, count * sizeof(T)) != 0)
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(memory);
+    }
+
+    void deallocate(T* memory, size_t) { std::free(memory); }
+};
+
+template <typename T, typename U>
+bool operator==(const CacheLineAllocator<T>&, const CacheLineAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const CacheLineAllocator<T>&, const CacheLineAllocator<U>&) { return false; }
+
+// All-pairs distances, row-major. The storage starts on a cache line and
+// rows are padded to whole cache lines, then handed to the workers in
+// blocks of 'BLOCK_ROWS', so no two threads ever write the same line.
+class DistanceMatrix
+{
+public:
+    static const int UNREACHED = 999999;
+    static const size_t BLOCK_ROWS = 16;
+
+    explicit DistanceMatrix(size_t size = 0)
+        : m_Size(size)
+        , m_Stride((size + 15) & ~size_t(15))
+        , m_Distances(size * m_Stride, UNREACHED)
+    {}
+
+    size_t size() const { return m_Size; }
+    size_t blockCount() const { return (m_Size + BLOCK_ROWS - 1) / BLOCK_ROWS; }
+
+    int at(int from, int to) const { return m_Distances[from * m_Stride + to]; }
+
+    int* row(int from) { return &m_Distances[from * m_Stride]; }
+    const int* row(int from) const { return &m_Distances[from * m_Stride]; }
+
+private:
+    size_t m_Size;
+    size_t m_Stride;
+    std::vector<int, CacheLineAllocator<int>> m_Distances;
+};
+
+const int DistanceMatrix::UNREACHED;
+const size_t DistanceMatrix::BLOCK_ROWS;
+
+// Potentials from SPFA on the graph extended with a virtual source that
+// has a zero-weight edge to every vertex. Returns false on a negative cycle.
+bool potentials(const Graph& graph, std::vector<int>& potential)
+{
+    const int size = graph.size();
+    Graph extended(size + 1);
+
+    for (int vertex = 0; vertex < size; ++vertex)
+    {
+        for (const Edge& edge: graph.connected(vertex))
+        {
+            extended.add(edge);
+        }
+        extended.add(size, vertex, 0);
+    }
+
+    std::vector<Result> result;
+    if (shortestPaths(extended, size, result))
+    {
+        return false;
+    }
+
+    potential.resize(size);
+    for (int vertex = 0; vertex < size; ++vertex)
+    {
+        potential[vertex] = result[vertex].path;
+    }
+    return true;
+}
+
+// CSR copy of 'graph' with every edge u -> v reweighted to
+// w + potential[u] - potential[v], which is never negative.
+CsrGraph reweight(const Graph& graph, const std::vector<int>& potential)
+{
+    CsrGraph csr;
+    csr.offsets.reserve(graph.size() + 1);
+    csr.offsets.push_back(0);
+
+    for (size_t vertex = 0; vertex < graph.size(); ++vertex)
+    {
+        for (const Edge& edge: graph.connected(vertex))
+        {
+            int weight = static_cast<int>(potential[vertex] + edge.weight()) - potential[edge.to()];
+            assert(weight >= 0);
+
+            csr.targets.push_back(edge.to());
+            csr.weights.push_back(weight);
+        }
+        csr.offsets.push_back(csr.targets.size());
+    }
+
+    return csr;
+}
+
+struct QueuedVertex
+{
+    int vertex;
+    int path;
+};
+
+bool operator<(const QueuedVertex& left, const QueuedVertex& right)
+{
+    return left.path < right.path || (left.path == right.path && left.vertex < right.vertex);
+}
+
+struct QueuedVertexKey
+{
+    int operator()(const QueuedVertex& queued) const
+    {
+        return queued.vertex;
+    }
+};
+
+typedef DaryHeap<QueuedVertex, 4, std::less<QueuedVertex>, KeyIndex<QueuedVertexKey>> Heap;
+
+// Dijkstra over the reweighted CSR graph, writing the original distances
+// into 'row'. 'distance' and 'heap' belong to the calling worker and are
+// reused from one source to the next; 'distance' is left all UNREACHED.
+void dijkstraRow(const CsrGraph& csr, const std::vector<int>& potential, int source,
+                 std::vector<int>& distance, std::vector<int>& touched, Heap& heap, int* row)
+{
+    distance[source] = 0;
+    touched.push_back(source);
+    heap.push({source, 0});
+
+    while (!heap.empty())
+    {
+        QueuedVertex current = heap.pop();
+        row[current.vertex] = current.path - potential[source] + potential[current.vertex];
+
+        for (uint32_t i = csr.offsets[current.vertex]; i < csr.offsets[current.vertex + 1]; ++i)
+        {
+            int next = csr.targets[i];
+            int path = current.path + csr.weights[i];
+            if (path < distance[next])
+            {
+                if (distance[next] == DistanceMatrix::UNREACHED)
+                {
+                    touched.push_back(next);
+                }
+                distance[next] = path;
+                heap.pushOrDecrease({next, path});
+            }
+        }
+    }
+
+    for (int vertex: touched)
+    {
+        distance[vertex] = DistanceMatrix::UNREACHED;
+    }
+    touched.clear();
+}
+
+// Johnson's all-pairs shortest paths: one SPFA from a virtual source for
+// the potentials, then one Dijkstra per source on the reweighted graph.
+// The workers claim blocks of rows from a shared counter. Returns false,
+// leaving 'distances' untouched, if the graph has a negative cycle.
+bool Johnson(const Graph& graph, DistanceMatrix& distances, uint threadCount = 0)
+{
+    std::vector<int> potential;
+    if (!potentials(graph, potential))
+    {
+        return false;
+    }
+
+    const CsrGraph csr = reweight(graph, potential);
+    DistanceMatrix result(graph.size());
+
+    if (!threadCount)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = std::max<size_t>(1, std::min<size_t>(threadCount, result.blockCount()));
+
+    std::atomic<size_t> nextBlock(0);
+    auto worker = [&]()
+    {
+        std::vector<int> distance(csr.size(), DistanceMatrix::UNREACHED);
+        std::vector<int> touched;
+        Heap heap(csr.size());
+
+        for (size_t block; (block = nextBlock++) < result.blockCount(); )
+        {
+            size_t end = std::min(result.size(), (block + 1) * DistanceMatrix::BLOCK_ROWS);
+            for (size_t source = block * DistanceMatrix::BLOCK_ROWS; source < end; ++source)
+            {
+                dijkstraRow(csr, potential, source, distance, touched, heap, result.row(source));
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (uint t = 1; t < threadCount; ++t)
+    {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread: workers)
+    {
+        thread.join();
+    }
+
+    distances = std::move(result);
+    return true;
+}
+
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+class Test: public CPPUNIT_NS::TestFixture
+{
+    CPPUNIT_TEST_SUITE( Test ); 
+
+    CPPUNIT_TEST( test1 );
+    CPPUNIT_TEST( test2 );
+    CPPUNIT_TEST( test3 );
+    CPPUNIT_TEST( test4 );
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void test1();
+    void test2();
+    void test3();
+    void test4();
+};
+CPPUNIT_TEST_SUITE_REGISTRATION( Test );
+
+std::vector<int> matrixRow(const DistanceMatrix& distances, int from)
+{
+    return std::vector<int>(distances.row(from), distances.row(from) + distances.size());
+}
+
+void Test::test1()
+{
+    Graph graph(5);
+
+    graph.add('A', 'B', 3);
+    graph.add('A', 'C', 8);
+    graph.add('A', 'E', -4);
+    graph.add('B', 'D', 1);
+    graph.add('B', 'E', 7);
+    graph.add('C', 'B', 4);
+    graph.add('D', 'A', 2);
+    graph.add('D', 'C', -5);
+    graph.add('E', 'D', 6);
+
+    DistanceMatrix distances;
+    CPPUNIT_ASSERT(Johnson(graph, distances));
+
+    std::vector<std::vector<int>> expect = {
+        { 0,  1, -3,  2, -4},
+        { 3,  0, -4,  1, -1},
+        { 7,  4,  0,  5,  3},
+        { 2, -1, -5,  0, -2},
+        { 8,  5,  1,  6,  0}};
+
+    for (int from = 0; from < 5; ++from)
+    {
+        CPPUNIT_ASSERT_EQUAL(expect[from], matrixRow(distances, from));
+        CPPUNIT_ASSERT_EQUAL(uintptr_t(0), reinterpret_cast<uintptr_t>(distances.row(from)) % 64);
+    }
+}
+
+void Test::test2()
+{
+    // B -> C -> D -> B weighs -1
+    Graph graph(4);
+
+    graph.add('A', 'B', 1);
+    graph.add('B', 'C', 2);
+    graph.add('C', 'D', -4);
+    graph.add('D', 'B', 1);
+
+    DistanceMatrix distances(4);
+    CPPUNIT_ASSERT(!Johnson(graph, distances));
+    CPPUNIT_ASSERT_EQUAL(size_t(4), distances.size());
+    CPPUNIT_ASSERT_EQUAL(int(DistanceMatrix::UNREACHED), distances.at(0, 1));
+}
+
+void Test::test3()
+{
+    // D and E are cut off from A, B, C
+    Graph graph(5);
+
+    graph.add('A', 'B', -2);
+    graph.add('B', 'C', -3);
+    graph.add('D', 'E', 4);
+    graph.add('E', 'A', -1);
+
+    DistanceMatrix distances;
+    CPPUNIT_ASSERT(Johnson(graph, distances));
+
+    const int X = DistanceMatrix::UNREACHED;
+    std::vector<std::vector<int>> expect = {
+        { 0, -2, -5,  X,  X},
+        { X,  0, -3,  X,  X},
+        { X,  X,  0,  X,  X},
+        { 3,  1, -2,  0,  4},
+        {-1, -3, -6,  X,  0}};
+
+    for (int from = 0; from < 5; ++from)
+    {
+        CPPUNIT_ASSERT_EQUAL(expect[from], matrixRow(distances, from));
+    }
+}
+
+void Test::test4()
+{
+    // negative edges without negative cycles: weight + p[from] - p[to] with
+    // a non-negative weight; every row matches SPFA from that source
+    const int size = 70;
+    Graph graph(size);
+
+    std::vector<int> p(size);
+    for (int vertex = 0; vertex < size; ++vertex)
+    {
+        p[vertex] = (vertex * 37) % 23;
+    }
+    for (int vertex = 0; vertex < size; ++vertex)
+    {
+        for (int k = 1; k <= 4; ++k)
+        {
+            int next = (vertex * 7 + k * 13) % size;
+            graph.add(vertex, next, (vertex + k) % 5 + p[vertex] - p[next]);
+        }
+    }
+
+    for (uint threads: {1u, 4u})
+    {
+        DistanceMatrix distances;
+        CPPUNIT_ASSERT(Johnson(graph, distances, threads));
+
+        for (int from = 0; from < size; ++from)
+        {
+            std::vector<Result> result;
+            CPPUNIT_ASSERT(!shortestPaths(graph, from, result));
+
+            for (int to = 0; to < size; ++to)
+            {
+                CPPUNIT_ASSERT_EQUAL(result[to].path, distances.at(from, to));
+            }
+        }
+    }
+}
+
+int main()
+{
+    CppUnit::TextUi::TestRunner runner;
+    CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+    runner.addTest( registry.makeTest() );
+    runner.run();
+    return 0;
+}
@@ -4,6 +4,14 @@
 #include <limits>
 #include <iostream>
 #include <assert.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
@@ -54,74 +62,89 @@ enum State
     WITHIN_PATH
 };
 
-bool isAcyclicImpl(const Graph& graph, int vertex, std::vector<State>& marked)
+// One DFS over the graph: a topological order when it is acyclic,
+// otherwise the first cycle met, as a vertex sequence in which each vertex
+// has an edge to the next and the last one to the first.
+struct TopologicalSort
 {
-    marked[vertex] = WITHIN_PATH;
+    bool acyclic;
+    std::vector<int> order;
+    std::vector<int> cycle;
+};
 
-    for (const Edge& edge: graph.connected(vertex))
+// Iterative three-color DFS from 'root', or from every vertex when 'root'
+// is -1; the reverse post-order is the topological order. Stops at the
+// first edge back into the current path.
+TopologicalSort sortTopologically(const Graph& graph, int root = -1)
+{
+    TopologicalSort result = {true, {}, {}};
+    std::vector<State> marked(graph.size(), UNVISITED);
+    std::vector<std::pair<int, size_t>> stack;
+
+    const int first = root == -1 ? 0 : root;
+    const int last = root == -1 ? graph.size() : root + 1;
+    for (int start = first; start < last; ++start)
     {
-        int next = edge.to();
-        if (marked[next] == UNVISITED)
-        {
-            if (isAcyclicImpl(graph, next, marked) == false)
-            {
-                return false;
-            }
-        }
-        if (marked[next] == WITHIN_PATH)
+        if (marked[start] != UNVISITED)
         {
-            return false;
+            continue;
         }
-    }
 
-    marked[vertex] = DISCOVERED;
+        marked[start] = WITHIN_PATH;
+        stack.push_back({start, 0});
 
-    return true;
-}
+        while (!stack.empty())
+        {
+            int vertex = stack.back().first;
+            size_t& edge = stack.back().second;
+            const std::vector<Edge>& edges = graph.connected(vertex);
 
-bool isAcyclic(const  Graph& graph)
-{
-    int vertex = 0;
-    for (; vertex < graph.size(); ++vertex)
-    {
-        if (!graph.connected(vertex).empty())
-        { break;}
-    }
+            if (edge == edges.size())
+            {
+                marked[vertex] = DISCOVERED;
+                result.order.push_back(vertex);
+                stack.pop_back();
+                continue;
+            }
 
-    if (vertex != graph.size())
-    {
-        std::vector<State> marked(graph.size(), UNVISITED);
-        return isAcyclicImpl(graph, vertex, marked);
+            int next = edges[edge++].to();
+            if (marked[next] == UNVISITED)
+            {
+                marked[next] = WITHIN_PATH;
+                stack.push_back({next, 0});
+            }
+            else if (marked[next] == WITHIN_PATH)
+            {
+                auto begin = std::find_if(stack.begin(), stack.end(),
+                                          [next](const std::pair<int, size_t>& entry) { return entry.first == next; });
+                for (auto it = begin; it != stack.end(); ++it)
+                {
+                    result.cycle.push_back(it->first);
+                }
+                result.acyclic = false;
+                result.order.clear();
+                return result;
+            }
+        }
     }
 
-    return false;
+    std::reverse(result.order.begin(), result.order.end());
+    return result;
 }
 
-
-void dfs_impl(const Graph& graph, int vertex, std::vector<bool>& marked, std::vector<int>& result)
+// A graph without edges is acyclic too.
+bool isAcyclic(const  Graph& graph)
 {
-    marked[vertex] = true;
-
-    for (const Edge& edge: graph.connected(vertex))
-    {
-        int next = edge.to();
-
-        if (marked[next] == false)
-        {
-            dfs_impl(graph, next, marked, result);
-        }
-    }
-    result.push_back(vertex);
+    return sortTopologically(graph).acyclic;
 }
 
-
+// Post-order of the vertices reachable from 'vertex', which must not
+// reach a cycle.
 std::vector<int> getTopologicalOrder(const Graph& graph, int vertex)
 {
-    std::vector<int> result;
-    std::vector<bool> marked(graph.size(), false);
-
-    dfs_impl(graph, vertex, marked, result);
-    return result;
+    TopologicalSort sorted = sortTopologically(graph, vertex);
+    assert(sorted.acyclic);
+    return std::vector<int>(sorted.order.rbegin(), sorted.order.rend());
 }
 
 struct Result
@@ -178,6 +201,411 @@ std::vector<Result> getAcyclicMst(const Graph& graph, int source)
 }
 
 
+// Kahn levels of a DAG with its incoming edges in CSR form: a vertex's
+// level is one more than the highest level of its predecessors, so the
+// vertices of one level never depend on each other. Vertices on or behind
+// a cycle get no level.
+class DagSchedule
+{
+public:
+    explicit DagSchedule(const Graph& graph)
+        : m_Level(graph.size(), -1)
+        , m_InOffsets(graph.size() + 1, 0)
+    {
+        const int size = graph.size();
+
+        for (int vertex = 0; vertex < size; ++vertex)
+        {
+            for (const Edge& edge: graph.connected(vertex))
+            {
+                ++m_InOffsets[edge.to() + 1];
+            }
+        }
+        for (int vertex = 0; vertex < size; ++vertex)
+        {
+            m_InOffsets[vertex + 1] += m_InOffsets[vertex];
+        }
+
+        std::vector<int> fill(m_InOffsets.begin(), m_InOffsets.end() - 1);
+        m_InFrom.resize(m_InOffsets.back());
+        m_InWeight.resize(m_InOffsets.back());
+        for (int vertex = 0; vertex < size; ++vertex)
+        {
+            for (const Edge& edge: graph.connected(vertex))
+            {
+                m_InFrom[fill[edge.to()]] = vertex;
+                m_InWeight[fill[edge.to()]++] = edge.weight();
+            }
+        }
+
+        std::vector<int> missing(size);
+        for (int vertex = 0; vertex < size; ++vertex)
+        {
+            missing[vertex] = m_InOffsets[vertex + 1] - m_InOffsets[vertex];
+            if (missing[vertex] == 0)
+            {
+                m_Order.push_back(vertex);
+                m_Level[vertex] = 0;
+            }
+        }
+        m_LevelBegin.push_back(0);
+
+        for (size_t begin = 0; begin < m_Order.size(); )
+        {
+            size_t end = m_Order.size();
+            m_LevelBegin.push_back(end);
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                int vertex = m_Order[i];
+                for (const Edge& edge: graph.connected(vertex))
+                {
+                    if (--missing[edge.to()] == 0)
+                    {
+                        m_Level[edge.to()] = m_Level[vertex] + 1;
+                        m_Order.push_back(edge.to());
+                    }
+                }
+            }
+            begin = end;
+        }
+        m_LevelBegin.back() = m_Order.size();
+    }
+
+    int size() const { return m_Level.size(); }
+    int levelCount() const { return m_LevelBegin.size() - 1; }
+    int level(int vertex) const { return m_Level[vertex]; }
+
+    // vertices in level order; level 'l' is [levelBegin(l), levelBegin(l + 1))
+    const std::vector<int>& order() const { return m_Order; }
+    size_t levelBegin(int level) const { return m_LevelBegin[level]; }
+
+    uint inBegin(int vertex) const { return m_InOffsets[vertex]; }
+    uint inEnd(int vertex) const { return m_InOffsets[vertex + 1]; }
+    int inFrom(uint edge) const { return m_InFrom[edge]; }
+    float inWeight(uint edge) const { return m_InWeight[edge]; }
+
+private:
+    std::vector<int> m_Level;
+    std::vector<int> m_Order;
+    std::vector<size_t> m_LevelBegin;
+    std::vector<uint> m_InOffsets;
+    std::vector<int> m_InFrom;
+    std::vector<float> m_InWeight;
+};
+
+enum PathMode
+{
+    SHORTEST_PATH,
+    LONGEST_PATH
+};
+
+// Reusable barrier for a fixed number of threads.
+class Barrier
+{
+public:
+    explicit Barrier(uint count)
+        : m_Count(count), m_Waiting(0), m_Generation(0)
+    {}
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        const uint64_t generation = m_Generation;
+        if (++m_Waiting == m_Count)
+        {
+            m_Waiting = 0;
+            ++m_Generation;
+            m_Changed.notify_all();
+        }
+        else
+        {
+            m_Changed.wait(lock, [&]() { return generation != m_Generation; });
+        }
+    }
+
+private:
+    std::mutex m_Mutex;
+    std::condition_variable m_Changed;
+    const uint m_Count;
+    uint m_Waiting;
+    uint64_t m_Generation;
+};
+
+// Pulls the best path into 'vertex' from its reached predecessors; ties
+// go to the lower predecessor.
+void pull(const DagSchedule& schedule, int vertex, PathMode mode, std::vector<Result>& result)
+{
+    Result best = {-1, 999999};
+
+    for (uint edge = schedule.inBegin(vertex); edge < schedule.inEnd(vertex); ++edge)
+    {
+        int from = schedule.inFrom(edge);
+        if (result[from].from == -1)
+        {
+            continue;
+        }
+
+        int path = result[from].path + schedule.inWeight(edge);
+        bool better = best.from == -1 ||
+                      (mode == SHORTEST_PATH ? path < best.path : path > best.path) ||
+                      (path == best.path && from < best.from);
+        if (better)
+        {
+            best = {from, path};
+        }
+    }
+
+    result[vertex] = best;
+}
+
+// DAG paths from 'source', level by level: the vertices of a level pull
+// from their predecessors. Levels of at least 2 * GRAIN vertices are split
+// over the threads, which meet at a barrier before and after such a level;
+// runs of smaller levels are handled by the first thread alone, without
+// barriers, so deep and narrow DAGs cost no synchronization per level.
+// Levels below the source's cannot be reached and are skipped. LONGEST_PATH
+// gives the critical path of a scheduling DAG. Unreached vertices get
+// {-1, 999999} in both modes.
+std::vector<Result> getAcyclicPaths(const DagSchedule& schedule, int source,
+                                    PathMode mode = SHORTEST_PATH, uint threadCount = 0)
+{
+    const size_t GRAIN = 1024;
+
+    std::vector<Result> result(schedule.size(), {-1, 999999});
+    assert(schedule.level(source) != -1);
+    result[source] = {source, 0};
+
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const int firstLevel = schedule.level(source) + 1;
+
+    // no more threads than the widest level can use
+    size_t widest = 0;
+    for (int level = firstLevel; level < schedule.levelCount(); ++level)
+    {
+        widest = std::max(widest, schedule.levelBegin(level + 1) - schedule.levelBegin(level));
+    }
+    threadCount = std::max<size_t>(1, std::min<size_t>(threadCount, widest / GRAIN));
+
+    Barrier barrier(threadCount);
+    auto worker = [&](uint thread)
+    {
+        // whether the first thread ran small levels since the last barrier
+        bool alone = false;
+
+        for (int level = firstLevel; level < schedule.levelCount(); ++level)
+        {
+            const size_t begin = schedule.levelBegin(level);
+            const size_t end = schedule.levelBegin(level + 1);
+            const uint threads = std::max<size_t>(1, std::min<size_t>(threadCount, (end - begin) / GRAIN));
+
+            if (threads == 1)
+            {
+                if (thread == 0)
+                {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        pull(schedule, schedule.order()[i], mode, result);
+                    }
+                }
+                alone = true;
+                continue;
+            }
+
+            if (alone)
+            {
+                barrier.wait();
+                alone = false;
+            }
+            if (thread < threads)
+            {
+                const size_t chunk = (end - begin + threads - 1) / threads;
+                const size_t last = std::min(end, begin + (thread + 1) * chunk);
+                for (size_t i = begin + thread * chunk; i < last; ++i)
+                {
+                    pull(schedule, schedule.order()[i], mode, result);
+                }
+            }
+            barrier.wait();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (uint t = 1; t < threadCount; ++t)
+    {
+        workers.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread& thread: workers)
+    {
+        thread.join();
+    }
+
+    return result;
+}
+
+std::vector<Result> getAcyclicPaths(const Graph& graph, int source, PathMode mode = SHORTEST_PATH, uint threadCount = 0)
+{
+    return getAcyclicPaths(DagSchedule(graph), source, mode, threadCount);
+}
+
+
+// DAG shortest paths from many sources at once. The topological order is
+// computed once; sources then run LANES at a time over a [vertex][lane]
+// matrix, one vector add/compare/blend per edge for all lanes, lanes not
+// reached at a vertex masked out. Edge weights must be whole numbers:
+// the lanes add int32 weights, which matches the truncated float sums of
+// getAcyclicPaths only then, so the constructor asserts it.
+class AcyclicBatch
+{
+public:
+#if defined(__AVX512F__)
+    static const int LANES = 16;
+#else
+    static const int LANES = 8;
+#endif
+    static const int32_t UNREACHED = 999999;
+
+    explicit AcyclicBatch(const Graph& graph)
+        : m_Graph(graph)
+    {
+        TopologicalSort sorted = sortTopologically(graph);
+        assert(sorted.acyclic);
+        m_Order.swap(sorted.order);
+
+        for (int vertex = 0; vertex < graph.size(); ++vertex)
+        {
+            for (const Edge& edge: graph.connected(vertex))
+            {
+                assert(edge.weight() == static_cast<int32_t>(edge.weight()));
+            }
+        }
+    }
+
+    void run(const std::vector<int>& sources)
+    {
+        const size_t size = m_Graph.size();
+        const size_t batches = (sources.size() + LANES - 1) / LANES;
+
+        m_Sources = sources;
+        m_Path.assign(batches * size * LANES, UNREACHED);
+        m_From.assign(batches * size * LANES, -1);
+
+        for (size_t batch = 0; batch < batches; ++batch)
+        {
+            int32_t* path = &m_Path[batch * size * LANES];
+            int32_t* from = &m_From[batch * size * LANES];
+
+            for (int lane = 0; lane < LANES && batch * LANES + lane < sources.size(); ++lane)
+            {
+                int source = sources[batch * LANES + lane];
+                path[source * LANES + lane] = 0;
+                from[source * LANES + lane] = source;
+            }
+
+            for (int vertex: m_Order)
+            {
+                relaxLanes(vertex, path, from);
+            }
+        }
+    }
+
+    // paths from the source with index 'source' in the last run
+    Result result(size_t source, int vertex) const
+    {
+        assert(source < m_Sources.size());
+        size_t index = ((source / LANES) * m_Graph.size() + vertex) * LANES + source % LANES;
+        return {m_From[index], m_Path[index]};
+    }
+
+    std::vector<Result> results(size_t source) const
+    {
+        std::vector<Result> results(m_Graph.size());
+        for (int vertex = 0; vertex < m_Graph.size(); ++vertex)
+        {
+            results[vertex] = result(source, vertex);
+        }
+        return results;
+    }
+
+private:
+    void relaxLanes(int vertex, int32_t* path, int32_t* from) const
+    {
+        const int32_t* row = path + vertex * LANES;
+
+#if defined(__AVX512F__)
+        const __m512i current = _mm512_loadu_si512(row);
+        const __mmask16 reached = _mm512_cmpneq_epi32_mask(current, _mm512_set1_epi32(UNREACHED));
+        if (!reached)
+        {
+            return;
+        }
+        const __m512i parent = _mm512_set1_epi32(vertex);
+
+        for (const Edge& edge: m_Graph.connected(vertex))
+        {
+            int32_t* next = path + edge.to() * LANES;
+            int32_t* nextFrom = from + edge.to() * LANES;
+
+            __m512i candidate = _mm512_add_epi32(current, _mm512_set1_epi32(static_cast<int32_t>(edge.weight())));
+            __m512i old = _mm512_loadu_si512(next);
+            __mmask16 better = _mm512_mask_cmplt_epi32_mask(reached, candidate, old);
+            _mm512_storeu_si512(next, _mm512_mask_mov_epi32(old, better, candidate));
+            _mm512_storeu_si512(nextFrom, _mm512_mask_mov_epi32(_mm512_loadu_si512(nextFrom), better, parent));
+        }
+#elif defined(__AVX2__)
+        const __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row));
+        const __m256i unreached = _mm256_cmpeq_epi32(current, _mm256_set1_epi32(UNREACHED));
+        if (_mm256_movemask_epi8(unreached) == -1)
+        {
+            return;
+        }
+        const __m256i parent = _mm256_set1_epi32(vertex);
+
+        for (const Edge& edge: m_Graph.connected(vertex))
+        {
+            __m256i* next = reinterpret_cast<__m256i*>(path + edge.to() * LANES);
+            __m256i* nextFrom = reinterpret_cast<__m256i*>(from + edge.to() * LANES);
+
+            __m256i candidate = _mm256_add_epi32(current, _mm256_set1_epi32(static_cast<int32_t>(edge.weight())));
+            __m256i old = _mm256_loadu_si256(next);
+            __m256i better = _mm256_andnot_si256(unreached, _mm256_cmpgt_epi32(old, candidate));
+            _mm256_storeu_si256(next, _mm256_blendv_epi8(old, candidate, better));
+            _mm256_storeu_si256(nextFrom, _mm256_blendv_epi8(_mm256_loadu_si256(nextFrom), parent, better));
+        }
+#else
+        for (const Edge& edge: m_Graph.connected(vertex))
+        {
+            int32_t* next = path + edge.to() * LANES;
+            int32_t* nextFrom = from + edge.to() * LANES;
+
+            for (int lane = 0; lane < LANES; ++lane)
+            {
+                int32_t candidate = row[lane] + static_cast<int32_t>(edge.weight());
+                if (row[lane] != UNREACHED && candidate < next[lane])
+                {
+                    next[lane] = candidate;
+                    nextFrom[lane] = vertex;
+                }
+            }
+        }
+#endif
+    }
+
+    const Graph& m_Graph;
+    std::vector<int> m_Order;
+    std::vector<int> m_Sources;
+    std::vector<int32_t> m_Path;
+    std::vector<int32_t> m_From;
+};
+
+const int AcyclicBatch::LANES;
+const int32_t AcyclicBatch::UNREACHED;
+
+
 #include <cppunit/extensions/TestFactoryRegistry.h>
 #include <cppunit/ui/text/TestRunner.h>
 #include <cppunit/extensions/HelperMacros.h>
@@ -219,6 +647,8 @@ class Test: public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST( test2 );
     CPPUNIT_TEST( test3 );
     CPPUNIT_TEST( test4 );
+    CPPUNIT_TEST( test5 );
+    CPPUNIT_TEST( test6 );
 
     CPPUNIT_TEST_SUITE_END();
 
@@ -227,6 +657,8 @@ public:
     void test2();
     void test3();
     void test4();
+    void test5();
+    void test6();
 };
 CPPUNIT_TEST_SUITE_REGISTRATION( Test );
 
@@ -268,17 +700,252 @@ void Test::test1()
 
 void Test::test2()
 {
+    // the same DAG as test1, scheduled by levels
+    Graph graph(8);
+
+    graph.add(0, 1, 5);
+    graph.add(0, 4, 9);
+    graph.add(0, 7, 8);
+    graph.add(1, 2, 12);
+    graph.add(1, 3, 15);
+    graph.add(1, 7, 4);
+    graph.add(2, 3, 3);
+    graph.add(2, 6, 11);
+    graph.add(3, 6, 9);
+    graph.add(4, 5, 4);
+    graph.add(4, 6, 20);
+    graph.add(4, 7, 5);
+    graph.add(5, 2, 1);
+    graph.add(5, 6, 13);
+    graph.add(7, 2, 7);
+    graph.add(7, 5, 6);
+
+    DagSchedule schedule(graph);
+    CPPUNIT_ASSERT_EQUAL(7, schedule.levelCount());
+
+    std::vector<Result> expect = {{0, 0}, {0, 5}, {5, 14}, {2, 17}, {0, 9}, {4, 13}, {2, 25}, {0, 8}};
+    CPPUNIT_ASSERT_EQUAL(expect, getAcyclicPaths(schedule, 0));
+
+    // critical path 0 4 7 5 2 3 6
+    expect = {{0, 0}, {0, 5}, {5, 21}, {2, 24}, {0, 9}, {7, 20}, {3, 33}, {4, 14}};
+    CPPUNIT_ASSERT_EQUAL(expect, getAcyclicPaths(schedule, 0, LONGEST_PATH));
 
+    // nothing above 4 is reached from it
+    expect = {{-1, 999999}, {-1, 999999}, {5, 5}, {2, 8}, {4, 0}, {4, 4}, {2, 16}, {4, 5}};
+    CPPUNIT_ASSERT_EQUAL(expect, getAcyclicPaths(graph, 4));
 }
 
 void Test::test3()
 {
+    // layered DAG wide enough to split its levels: every thread count
+    // gives the sequential results in both modes
+    const int width = 3000;
+    const int depth = 6;
+    Graph graph(width * depth + 1);
+
+    uint seed = 7;
+    for (int column = 0; column < width; ++column)
+    {
+        graph.add(width * depth, column, column % 4);
+    }
+    for (int layer = 0; layer + 1 < depth; ++layer)
+    {
+        for (int column = 0; column < width; ++column)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                seed = seed * 1103515245 + 12345;
+                int next = (layer + 1) * width + (seed >> 8) % width;
+                graph.add(layer * width + column, next, int((seed >> 20) % 9) - 3);
+            }
+        }
+    }
+
+    DagSchedule schedule(graph);
+    for (PathMode mode: {SHORTEST_PATH, LONGEST_PATH})
+    {
+        std::vector<Result> sequential = getAcyclicPaths(schedule, width * depth, mode, 1);
+        CPPUNIT_ASSERT(sequential == getAcyclicPaths(schedule, width * depth, mode, 4));
+
+        for (int vertex = 0; vertex < width * depth; ++vertex)
+        {
+            const Result& result = sequential[vertex];
+            if (result.from == -1)
+            {
+                continue;
+            }
+            for (const Edge& edge: graph.connected(vertex))
+            {
+                int path = result.path + edge.weight();
+                CPPUNIT_ASSERT(mode == SHORTEST_PATH ? sequential[edge.to()].path <= path
+                                                     : sequential[edge.to()].path >= path);
+            }
+        }
+    }
 
+    // ties may pick other parents than the DFS order does
+    std::vector<Result> shortest = getAcyclicPaths(schedule, width * depth, SHORTEST_PATH, 4);
+    std::vector<Result> reference = getAcyclicMst(graph, width * depth);
+    for (int vertex = 0; vertex <= width * depth; ++vertex)
+    {
+        CPPUNIT_ASSERT_EQUAL(reference[vertex].path, shortest[vertex].path);
+    }
 }
 
 void Test::test4()
 {
+    // 0 has edges but reaches no cycle; 3 -> 4 -> 5 -> 3 sits elsewhere
+    Graph graph(6);
+
+    graph.add(0, 1, 1);
+    graph.add(1, 2, 1);
+    graph.add(3, 4, 1);
+    graph.add(4, 5, 1);
+    graph.add(5, 3, 1);
+    graph.add(2, 4, 1);
+
+    TopologicalSort sorted = sortTopologically(graph);
+    CPPUNIT_ASSERT(!sorted.acyclic);
+    CPPUNIT_ASSERT(!isAcyclic(graph));
+    std::vector<int> cycle = {4, 5, 3};
+    CPPUNIT_ASSERT_EQUAL(cycle, sorted.cycle);
+
+    CPPUNIT_ASSERT(isAcyclic(Graph(3)));
+
+    // reverse the back edge: every edge goes forward in the order
+    Graph dag(6);
+    dag.add(0, 1, 1);
+    dag.add(1, 2, 1);
+    dag.add(3, 4, 1);
+    dag.add(4, 5, 1);
+    dag.add(3, 5, 1);
+    dag.add(2, 4, 1);
+
+    sorted = sortTopologically(dag);
+    CPPUNIT_ASSERT(sorted.acyclic);
+    CPPUNIT_ASSERT(sorted.cycle.empty());
+    CPPUNIT_ASSERT_EQUAL(size_t(6), sorted.order.size());
+
+    std::vector<int> position(6);
+    for (size_t i = 0; i < sorted.order.size(); ++i)
+    {
+        position[sorted.order[i]] = i;
+    }
+    for (int vertex = 0; vertex < 6; ++vertex)
+    {
+        for (const Edge& edge: dag.connected(vertex))
+        {
+            CPPUNIT_ASSERT(position[vertex] < position[edge.to()]);
+        }
+    }
+
+    std::vector<int> postOrder = {5, 4, 2, 1, 0};
+    CPPUNIT_ASSERT_EQUAL(postOrder, getTopologicalOrder(dag, 0));
+}
+
+void Test::test5()
+{
+    // layered DAG with negative weights, more sources than one batch holds:
+    // every lane matches its own single-source run
+    const int width = 200;
+    const int depth = 8;
+    Graph graph(width * depth);
+
+    uint seed = 11;
+    for (int layer = 0; layer + 1 < depth; ++layer)
+    {
+        for (int column = 0; column < width; ++column)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                seed = seed * 1103515245 + 12345;
+                int next = (layer + 1) * width + (seed >> 8) % width;
+                graph.add(layer * width + column, next, int((seed >> 20) % 9) - 3);
+            }
+        }
+    }
+
+    std::vector<int> sources;
+    for (int i = 0; i < 2 * AcyclicBatch::LANES + 3; ++i)
+    {
+        sources.push_back((i * 37) % (width * depth));
+    }
+
+    AcyclicBatch batch(graph);
+    batch.run(sources);
+
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        std::vector<Result> expect = getAcyclicMst(graph, sources[i]);
+        std::vector<Result> result = batch.results(i);
+
+        for (int vertex = 0; vertex < width * depth; ++vertex)
+        {
+            CPPUNIT_ASSERT_EQUAL(expect[vertex].path, result[vertex].path);
+
+            int from = result[vertex].from;
+            if (from == -1 || from == vertex)
+            {
+                CPPUNIT_ASSERT_EQUAL(expect[vertex].from, from);
+                continue;
+            }
+            bool tight = false;
+            for (const Edge& edge: graph.connected(from))
+            {
+                tight = tight || (edge.to() == vertex && result[from].path + edge.weight() == result[vertex].path);
+            }
+            CPPUNIT_ASSERT(tight);
+        }
+    }
+}
+
+void Test::test6()
+{
+    // long chains of two-vertex levels around two wide levels: the narrow
+    // stretches run on one thread, the wide levels are split
+    const int depth = 20000;
+    const int width = 5000;
+    const int wideAt[] = {3000, 3001, 12000};
+    Graph graph(2 * depth + 3 * width);
+
+    uint seed = 11;
+    int wide = 2 * depth;
+    for (int layer = 0; layer + 1 < depth; ++layer)
+    {
+        for (int side = 0; side < 2; ++side)
+        {
+            seed = seed * 1103515245 + 12345;
+            graph.add(2 * layer + side, 2 * (layer + 1) + side, int((seed >> 8) % 7) - 2);
+            seed = seed * 1103515245 + 12345;
+            graph.add(2 * layer + side, 2 * (layer + 1) + 1 - side, int((seed >> 8) % 7) - 2);
+        }
 
+        // a wide level hangs between this layer and the next
+        if (std::find(std::begin(wideAt), std::end(wideAt), layer) != std::end(wideAt))
+        {
+            for (int column = 0; column < width; ++column, ++wide)
+            {
+                seed = seed * 1103515245 + 12345;
+                graph.add(2 * layer + column % 2, wide, int((seed >> 8) % 5));
+                graph.add(wide, 2 * (layer + 2) + column % 2, int((seed >> 16) % 5) - 4);
+            }
+        }
+    }
+
+    DagSchedule schedule(graph);
+    for (PathMode mode: {SHORTEST_PATH, LONGEST_PATH})
+    {
+        std::vector<Result> sequential = getAcyclicPaths(schedule, 0, mode, 1);
+        CPPUNIT_ASSERT(sequential == getAcyclicPaths(schedule, 0, mode, 4));
+        CPPUNIT_ASSERT(getAcyclicPaths(schedule, 1, mode, 1) == getAcyclicPaths(schedule, 1, mode, 3));
+    }
+
+    std::vector<Result> shortest = getAcyclicPaths(schedule, 0, SHORTEST_PATH, 4);
+    std::vector<Result> reference = getAcyclicMst(graph, 0);
+    for (size_t vertex = 0; vertex < graph.size(); ++vertex)
+    {
+        CPPUNIT_ASSERT_EQUAL(reference[vertex].path, shortest[vertex].path);
+    }
 }
 
 int main()